@@ -14,6 +14,7 @@
 #include "Engine/Core/StringUtils.hpp"
 #include <stdarg.h>
 #include <iostream>
+#include <string.h>
 
 
 //-----------------------------------------------------------------------------------------------
@@ -48,7 +49,7 @@ void DebuggerPrintf( char const* messageFormat, ... )
 	char messageLiteral[ MESSAGE_MAX_LENGTH ];
 	va_list variableArgumentList;
 	va_start( variableArgumentList, messageFormat );
-	vsnprintf_s( messageLiteral, MESSAGE_MAX_LENGTH, _TRUNCATE, messageFormat, variableArgumentList );
+	vsnprintf( messageLiteral, MESSAGE_MAX_LENGTH, messageFormat, variableArgumentList );
 	va_end( variableArgumentList );
 	messageLiteral[ MESSAGE_MAX_LENGTH - 1 ] = '\0'; // In case vsnprintf overran (doesn't auto-terminate)
 
@@ -81,6 +82,26 @@ UINT GetWindowsMessageBoxIconFlagForSeverityLevel( MsgSeverityLevel severity )
 #endif
 
 
+//-----------------------------------------------------------------------------------------------
+// Dialogues are Windows only; elsewhere errors just go to stdout and the app exits
+//
+static void ShowDialogueCursor()
+{
+#if defined( PLATFORM_WINDOWS )
+	ShowCursor( TRUE );
+#endif
+}
+
+
+//-----------------------------------------------------------------------------------------------
+static void DebugBreakIfAvailable()
+{
+#if defined( PLATFORM_WINDOWS )
+	__debugbreak();
+#endif
+}
+
+
 //-----------------------------------------------------------------------------------------------
 char const* FindStartOfFileNameWithinFilePath( char const* filePath )
 {
@@ -182,7 +203,7 @@ int SystemDialogue_YesNoCancel( std::string const& messageTitle, std::string con
 
 
 //-----------------------------------------------------------------------------------------------
-__declspec( noreturn ) void FatalError( char const* filePath, char const* functionName, int lineNum, std::string const& reasonForError, char const* conditionText )
+[[noreturn]] void FatalError( char const* filePath, char const* functionName, int lineNum, std::string const& reasonForError, char const* conditionText )
 {
 	std::string errorMessage = reasonForError;
 	if( reasonForError.empty() )
@@ -198,7 +219,7 @@ __declspec( noreturn ) void FatalError( char const* filePath, char const* functi
 	std::string fullMessageTitle = appName + " :: Error";
 	std::string fullMessageText = errorMessage;
 	fullMessageText += "\n\nThe application will now close.\n";
-	bool isDebuggerPresent = (IsDebuggerPresent() == TRUE);
+	bool isDebuggerPresent = IsDebuggerAvailable();
 	if( isDebuggerPresent )
 	{
 		fullMessageText += "\nDEBUGGER DETECTED!\nWould you like to break and debug?\n  (Yes=debug, No=quit)\n";
@@ -224,16 +245,16 @@ __declspec( noreturn ) void FatalError( char const* filePath, char const* functi
 	if( isDebuggerPresent )
 	{
 		bool isAnswerYes = SystemDialogue_YesNo( fullMessageTitle, fullMessageText, MsgSeverityLevel::FATAL );
-		ShowCursor( TRUE );
+		ShowDialogueCursor();
 		if( isAnswerYes )
 		{
- 			__debugbreak();
+			DebugBreakIfAvailable();
 		}
 	}
 	else
 	{
 		SystemDialogue_Okay( fullMessageTitle, fullMessageText, MsgSeverityLevel::FATAL );
-		ShowCursor( TRUE );
+		ShowDialogueCursor();
 	}
 
 	exit( 0 );
@@ -257,7 +278,7 @@ void RecoverableWarning( char const* filePath, char const* functionName, int lin
 	std::string fullMessageTitle = appName + " :: Warning";
 	std::string fullMessageText = errorMessage;
 
-	bool isDebuggerPresent = (IsDebuggerPresent() == TRUE);
+	bool isDebuggerPresent = IsDebuggerAvailable();
 	if( isDebuggerPresent )
 	{
 		fullMessageText += "\n\nDEBUGGER DETECTED!\nWould you like to continue running?\n  (Yes=continue, No=quit, Cancel=debug)\n";
@@ -287,20 +308,20 @@ void RecoverableWarning( char const* filePath, char const* functionName, int lin
 	if( isDebuggerPresent )
 	{
 		int answerCode = SystemDialogue_YesNoCancel( fullMessageTitle, fullMessageText, MsgSeverityLevel::WARNING );
-		ShowCursor( TRUE );
+		ShowDialogueCursor();
 		if( answerCode == 0 ) // "NO"
 		{
 			exit( 0 );
 		}
 		else if( answerCode == -1 ) // "CANCEL"
 		{
-			__debugbreak();
+			DebugBreakIfAvailable();
 		}
 	}
 	else
 	{
 		bool isAnswerYes = SystemDialogue_YesNo( fullMessageTitle, fullMessageText, MsgSeverityLevel::WARNING );
-		ShowCursor( TRUE );
+		ShowDialogueCursor();
 		if( !isAnswerYes )
 		{
 			exit( 0 );
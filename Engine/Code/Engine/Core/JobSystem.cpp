@@ -1,32 +1,233 @@
 #include "Engine/Core/JobSystem.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Core/Time.hpp"
+
+JobSystem* g_theJobSystem = nullptr;
+
+// Worker owning the calling thread, so jobs queued from inside a job stay on that worker's deque
+static thread_local JobWorker* s_currentWorker = nullptr;
 
 JobWorker::JobWorker(int id, JobSystem* system)
 {
 	m_id = id;
 	m_system = system;
-	m_thread = new std::thread(&JobWorker::ThreadMain, this);
+	m_stealCursor = (unsigned int)id + 1;
 }
 
 JobWorker::~JobWorker()
 {
-	m_thread->join();
+	JoinThread();
+}
+
+void JobWorker::StartThread()
+{
+	m_thread = new std::thread(&JobWorker::ThreadMain, this);
+}
+
+void JobWorker::JoinThread()
+{
+	if (m_thread)
+	{
+		m_thread->join();
+		delete m_thread;
+		m_thread = nullptr;
+	}
 }
 
 void JobWorker::ThreadMain()
 {
+	s_currentWorker = this;
+
+	int numIdleSpins = 0;
 	while (!m_system->m_isShuttingDown)
 	{
 		Job* jobToExecute = m_system->ClaimJob(this);
 		if (jobToExecute)
 		{
-			jobToExecute->Execute();
-			m_system->CompleteJob(jobToExecute);
+			m_system->ExecuteJob(jobToExecute, this);
+			numIdleSpins = 0;
+		}
+		else if (numIdleSpins < m_system->m_config.m_numSpinsBeforeSleep)
+		{
+			// Short spin so back-to-back jobs in a frame burst don't pay for a park/wake round trip
+			numIdleSpins++;
+			std::this_thread::yield();
 		}
 		else
 		{
-			std::this_thread::sleep_for(std::chrono::microseconds(1));
+			jobToExecute = ParkUntilWoken();
+			if (jobToExecute)
+			{
+				m_system->ExecuteJob(jobToExecute, this);
+			}
+			numIdleSpins = 0;
+		}
+	}
+
+	s_currentWorker = nullptr;
+}
+
+Job* JobWorker::ParkUntilWoken()
+{
+	m_isParked = true;
+	m_system->m_numParkedWorkers++;
+
+	// Final look after announcing we are parked: a job queued before this point is found here,
+	// one queued after it sees m_isParked and wakes us, so no wake-up can be lost in between
+	Job* job = m_system->ClaimJob(this, true, false);
+	if (!job)
+	{
+		std::unique_lock<std::mutex> lock(m_wakeMutex);
+		m_wakeCondition.wait(lock, [this]() { return m_hasWakeSignal || m_system->m_isShuttingDown; });
+		m_hasWakeSignal = false;
+	}
+
+	m_system->m_numParkedWorkers--;
+	m_isParked = false;
+	return job;
+}
+
+void JobWorker::Wake()
+{
+	m_wakeMutex.lock();
+	m_hasWakeSignal = true;
+	m_wakeMutex.unlock();
+	m_wakeCondition.notify_one();
+}
+
+void JobWorker::PushLocalJob(Job* job)
+{
+	m_localJobsMutex.lock();
+	m_localJobs[(int)job->m_priority].PushBack(job);
+	m_localJobsMutex.unlock();
+}
+
+Job* JobWorker::PopLocalJob(int priority)
+{
+	m_localJobsMutex.lock();
+	JobQueue& localJobs = m_localJobs[priority];
+
+	// The newest job is almost always runnable; only scan further if the flags were changed after queuing
+	for (size_t i = localJobs.GetSize(); i > 0; i--)
+	{
+		Job* job = localJobs.GetJob(i - 1);
+		if (CanExecute(job))
+		{
+			localJobs.Erase(i - 1);
+			m_localJobsMutex.unlock();
+			return job;
+		}
+	}
+
+	m_localJobsMutex.unlock();
+	return nullptr;
+}
+
+Job* JobWorker::StealJob(unsigned int thiefBitflags, int priority, bool canBlock)
+{
+	// try_lock so a thief never stalls the owner or another thief, it just moves on to the next victim.
+	// A worker about to park blocks instead, otherwise a busy deque could hide a job from its last check
+	if (canBlock)
+	{
+		m_localJobsMutex.lock();
+	}
+	else if (!m_localJobsMutex.try_lock())
+	{
+		return nullptr;
+	}
+
+	JobQueue& localJobs = m_localJobs[priority];
+	for (size_t i = 0; i < localJobs.GetSize(); i++)
+	{
+		Job* job = localJobs.GetJob(i);
+		if ((job->m_Bitflags & thiefBitflags) != 0)
+		{
+			localJobs.Erase(i);
+			m_localJobsMutex.unlock();
+			return job;
+		}
+	}
+
+	m_localJobsMutex.unlock();
+	return nullptr;
+}
+
+bool JobWorker::CanExecute(Job const* job) const
+{
+	return (job->m_Bitflags & m_jobTypeBitflags) != 0;
+}
+
+JobQueue::JobQueue()
+{
+	m_capacity = JOB_QUEUE_INITIAL_CAPACITY;
+	m_jobs = new Job*[m_capacity];
+}
+
+JobQueue::~JobQueue()
+{
+	delete[] m_jobs;
+	m_jobs = nullptr;
+}
+
+void JobQueue::PushBack(Job* job)
+{
+	if (m_size == m_capacity)
+	{
+		Grow();
+	}
+	m_jobs[(m_head + m_size) & (m_capacity - 1)] = job;
+	m_size++;
+}
+
+Job* JobQueue::PopFront()
+{
+	Job* job = m_jobs[m_head];
+	m_head = (m_head + 1) & (m_capacity - 1);
+	m_size--;
+	return job;
+}
+
+void JobQueue::Erase(size_t index)
+{
+	size_t mask = m_capacity - 1;
+	if (index < m_size / 2)
+	{
+		for (size_t i = index; i > 0; i--)
+		{
+			m_jobs[(m_head + i) & mask] = m_jobs[(m_head + i - 1) & mask];
+		}
+		m_head = (m_head + 1) & mask;
+	}
+	else
+	{
+		for (size_t i = index; i + 1 < m_size; i++)
+		{
+			m_jobs[(m_head + i) & mask] = m_jobs[(m_head + i + 1) & mask];
 		}
 	}
+	m_size--;
+}
+
+void JobQueue::Grow()
+{
+	size_t newCapacity = m_capacity * 2;
+	Job** newJobs = new Job*[newCapacity];
+	for (size_t i = 0; i < m_size; i++)
+	{
+		newJobs[i] = GetJob(i);
+	}
+	delete[] m_jobs;
+	m_jobs = newJobs;
+	m_capacity = newCapacity;
+	m_head = 0;
+}
+
+void JobTimeline::AddEvent(JobTimelineEvent const& event)
+{
+	m_mutex.lock();
+	m_events[m_numEventsAdded % JOB_TIMELINE_CAPACITY] = event;
+	m_numEventsAdded++;
+	m_mutex.unlock();
 }
 
 JobSystem::JobSystem(JobSystemConfig config)
@@ -41,36 +242,73 @@ void JobSystem::Startup()
 	{
 		m_config.m_numWorkers = std::thread::hardware_concurrency() - 1;
 	}
+
+	m_jobPoolMutex.lock();
+	while (m_numJobPoolBlocks * JOB_POOL_BLOCK_SIZE < m_config.m_numPreallocatedJobs)
+	{
+		AddJobPoolBlock();
+	}
+	m_jobPoolMutex.unlock();
+
+	m_isCollectingStats = m_config.m_collectStats;
+	m_statsStartSeconds = GetCurrentTimeSeconds();
+
 	CreateWorkers(m_config.m_numWorkers);
 }
 
 void JobSystem::BeginFrame()
 {
+	double frameStartSeconds = GetCurrentTimeSeconds();
+	m_frameStartSeconds = frameStartSeconds;
+	m_isInFrame = true;
 
+	m_frameStartHistory[m_numFramesStarted % JOB_FRAME_HISTORY] = frameStartSeconds;
+	m_numFramesStarted++;
 }
 
 void JobSystem::EndFrame()
 {
+	m_isInFrame = false;
 
+	// Workers that only saw held-back background jobs parked without being woken for them
+	if (m_numQueuedJobsByPriority[(int)JobPriority::BACKGROUND] > 0)
+	{
+		WakeAllWorkers();
+	}
 }
 
 void JobSystem::Shutdown()
 {
 	m_isShuttingDown = true;
+	WakeAllWorkers();
 	DestroyWorkers();
+	DestroyJobPool();
 }
 
 void JobSystem::CreateWorkers(int num)
 {
+	int firstNewWorker = (int)m_workers.size();
 	for (int i = 0; i < num; i++)
 	{
-		JobWorker* newWorker = new JobWorker(i, this);
+		JobWorker* newWorker = new JobWorker(firstNewWorker + i, this);
 		m_workers.push_back(newWorker);
 	}
+
+	// Threads start only once every deque exists, since idle workers walk m_workers to steal
+	for (size_t i = firstNewWorker; i < m_workers.size(); i++)
+	{
+		m_workers[i]->StartThread();
+	}
 }
 
 void JobSystem::DestroyWorkers()
 {
+	// Every thread has to stop before any deque goes away, a worker may still be stealing from another
+	for (size_t i = 0; i < m_workers.size(); i++)
+	{
+		m_workers[i]->JoinThread();
+	}
+
 	for (size_t i = 0; i < m_workers.size(); i++)
 	{
 		delete m_workers[i];
@@ -82,154 +320,991 @@ void JobSystem::DestroyWorkers()
 
 void JobSystem::QueueJob(Job* jobToQueue)
 {
-	m_queuedJobsMutex.lock();
-	jobToQueue->m_state = JobState::QUEUED;
-	m_queuedJobs.push_back(jobToQueue);
-	m_queuedJobsMutex.unlock();
+	// Drop the reference QueueJob holds; with prerequisites still running the last one to finish schedules it
+	jobToQueue->m_state = JobState::WAITING;
+	if (jobToQueue->m_numPendingDependencies.fetch_sub(1) == 1)
+	{
+		ScheduleJob(jobToQueue);
+	}
 }
 
-Job* JobSystem::ClaimJob(JobWorker* worker)
+void JobSystem::QueueJobAfter(Job* jobToQueue, std::vector<Job*> const& prerequisites)
 {
-	m_queuedJobsMutex.lock();
+	for (size_t i = 0; i < prerequisites.size(); i++)
+	{
+		AddDependency(jobToQueue, prerequisites[i]);
+	}
+	QueueJob(jobToQueue);
+}
+
+void JobSystem::AddDependency(Job* job, Job* prerequisite)
+{
+	// job must not be queued yet. An AUTO_RELEASE prerequisite must not be queued yet either,
+	// since it may already be released by the time we get here
+	prerequisite->m_continuationsMutex.lock();
+	if (!prerequisite->m_hasFinished)
+	{
+		job->m_numPendingDependencies++;
+		prerequisite->m_continuations.push_back(job);
+	}
+	prerequisite->m_continuationsMutex.unlock();
+}
+
+bool JobSystem::AddDependencyIfPending(Job* job, JobHandle prerequisite)
+{
+	if (!prerequisite.IsValid())
+	{
+		return false;
+	}
+	int blockIndex = (int)(prerequisite.m_index / JOB_POOL_BLOCK_SIZE);
+	if (blockIndex >= m_numJobPoolBlocks)
+	{
+		return false;
+	}
+
+	// FreePooledJob bumps the generation under the same lock, and a job is only freed after m_hasFinished is set.
+	// So inside the lock a matching generation and an unfinished job mean the slot can't be recycled under us
+	FunctionJob* slot = &m_jobPoolBlocks[blockIndex][prerequisite.m_index % JOB_POOL_BLOCK_SIZE];
+	bool isPending = false;
+	slot->m_continuationsMutex.lock();
+	if (slot->m_generation == prerequisite.m_generation && !slot->m_hasFinished)
+	{
+		job->m_numPendingDependencies++;
+		slot->m_continuations.push_back(job);
+		isPending = true;
+	}
+	slot->m_continuationsMutex.unlock();
+	return isPending;
+}
+
+void JobSystem::WaitForJob(Job* job)
+{
+	// Help with other work instead of blocking, on a worker this also keeps nested waits from deadlocking
+	JobWorker* worker = s_currentWorker;
+	if (worker && worker->m_system != this)
+	{
+		worker = nullptr;
+	}
+
+	while (job->m_state != JobState::COMPLETED && job->m_state != JobState::RETRIEVED)
+	{
+		if (!HelpWithQueuedJob(worker))
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+void JobSystem::WaitForJob(JobHandle handle)
+{
+	JobWorker* worker = s_currentWorker;
+	if (worker && worker->m_system != this)
+	{
+		worker = nullptr;
+	}
+
+	// An AUTO_RELEASE job goes back to the pool as it completes, so a stale handle also means done
+	for (Job* job = GetJob(handle); job; job = GetJob(handle))
+	{
+		if (job->m_state == JobState::COMPLETED || job->m_state == JobState::RETRIEVED)
+		{
+			return;
+		}
+		if (!HelpWithQueuedJob(worker))
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+void JobSystem::ReleaseJob(Job* job)
+{
+	if (job->m_poolIndex != INVALID_JOB_POOL_INDEX)
+	{
+		FreePooledJob(static_cast<FunctionJob*>(job));
+		return;
+	}
+	delete job;
+}
+
+void JobSystem::ReleaseJob(JobHandle handle)
+{
+	Job* job = GetJob(handle);
+	if (job)
+	{
+		ReleaseJob(job);
+	}
+}
+
+void JobSystem::QueueJob(JobHandle handle)
+{
+	Job* job = GetJob(handle);
+	GUARANTEE_OR_DIE(job != nullptr, "Queued a job handle that was already released");
+	QueueJob(job);
+}
 
-	if (m_queuedJobs.empty())
+Job* JobSystem::GetJob(JobHandle handle) const
+{
+	if (!handle.IsValid())
 	{
-		m_queuedJobsMutex.unlock();
 		return nullptr;
 	}
 
-	Job* job = m_queuedJobs.front();
+	int blockIndex = (int)(handle.m_index / JOB_POOL_BLOCK_SIZE);
+	if (blockIndex >= m_numJobPoolBlocks)
+	{
+		return nullptr;
+	}
 
-	if ((job->m_Bitflags & worker->m_jobTypeBitflags) == 0)
+	FunctionJob* job = &m_jobPoolBlocks[blockIndex][handle.m_index % JOB_POOL_BLOCK_SIZE];
+	if (job->m_generation != handle.m_generation)
 	{
-		m_queuedJobsMutex.unlock();
 		return nullptr;
 	}
+	return job;
+}
 
-	m_queuedJobs.pop_front();
-	m_queuedJobsMutex.unlock();
+JobHandle JobSystem::GetHandle(Job const* job) const
+{
+	JobHandle handle;
+	if (job && job->m_poolIndex != INVALID_JOB_POOL_INDEX)
+	{
+		handle.m_index = job->m_poolIndex;
+		handle.m_generation = static_cast<FunctionJob const*>(job)->m_generation;
+	}
+	return handle;
+}
 
-	job->m_state = JobState::EXECUTING;
+void JobSystem::ScheduleJob(Job* jobToQueue)
+{
+	int priority = (int)jobToQueue->m_priority;
+	jobToQueue->m_queuedSeconds = m_isCollectingStats ? GetCurrentTimeSeconds() : 0.0;
+	jobToQueue->m_state = JobState::QUEUED;
+	m_numQueuedJobs++;
+	m_numQueuedJobsByPriority[priority]++;
+
+	// Jobs spawned from a job stay on the spawning worker when it can run them, they are the hottest in cache
+	JobWorker* worker = s_currentWorker;
+	if (!worker || worker->m_system != this || !worker->CanExecute(jobToQueue))
+	{
+		worker = FindWorkerForJob(jobToQueue);
+	}
 
-	m_executingJobsMutex.lock();
-	m_executingJobs.push_back(job);
-	m_executingJobsMutex.unlock();
+	if (worker)
+	{
+		// Once pushed the job may run and be released on another thread, so read its flags first
+		unsigned int jobBitflags = jobToQueue->m_Bitflags;
+		worker->PushLocalJob(jobToQueue);
+		WakeWorkerForJob(jobBitflags, worker);
+		return;
+	}
 
-	return job;
+	m_queuedJobsMutex.lock();
+	m_queuedJobs[priority].PushBack(jobToQueue);
+	m_numSharedQueuedJobs[priority]++;
+	m_queuedJobsMutex.unlock();
+}
+
+Job* JobSystem::ClaimJob(JobWorker* worker)
+{
+	return ClaimJob(worker, false, false);
 }
 
 void JobSystem::CompleteJob(Job* jobToComplete)
 {
-	m_executingJobsMutex.lock();
+	// The job counts as executing until it has landed wherever it goes, so ClearAllJobs never misses one on the way
+	ReleaseContinuations(jobToComplete);
 
-	for (size_t i = 0; i < m_executingJobs.size(); i++)
+	if (jobToComplete->m_completionPolicy == JobCompletionPolicy::AUTO_RELEASE)
 	{
-		if (m_executingJobs[i] == jobToComplete)
-		{
-			m_executingJobs.erase(m_executingJobs.begin() + i);
-			m_executingJobsMutex.unlock();
-			m_completedJobsMutex.lock();
-			jobToComplete->m_state = JobState::COMPLETED;
-			m_completedJobs.push_back(jobToComplete);
-			m_completedJobsMutex.unlock();
-			return;
-		}
+		ReleaseJob(jobToComplete);
+		m_numExecutingJobs--;
+		return;
+	}
+	if (jobToComplete->m_completionPolicy == JobCompletionPolicy::UNTRACKED)
+	{
+		// Last touch, the owner may free the job as soon as it sees this state
+		jobToComplete->m_state = JobState::COMPLETED;
+		m_numExecutingJobs--;
+		return;
 	}
 
-	m_executingJobsMutex.unlock();
-	return;
+	// Lock-free push onto the incoming stack; RetrieveJob moves it into the ordered list later.
+	// The state goes first because the job may be retrieved and freed as soon as it is on the stack
+	m_numCompletedJobs++;
+	jobToComplete->m_state = JobState::COMPLETED;
+	Job* head = m_incomingCompletedJobs.load();
+	do
+	{
+		jobToComplete->m_nextCompletedJob = head;
+	} while (!m_incomingCompletedJobs.compare_exchange_weak(head, jobToComplete));
+	m_numExecutingJobs--;
 }
 
 Job* JobSystem::RetrieveJob(Job* jobToRetrived)
 {
-	m_completedJobsMutex.lock();
-	if (!m_completedJobs.empty())
+	if (jobToRetrived)
 	{
-		if (jobToRetrived)
+		if (jobToRetrived->m_state != JobState::COMPLETED)
 		{
-			for (size_t i = 0; i < m_completedJobs.size(); i++)
-			{
-				if (m_completedJobs[i] == jobToRetrived)
-				{
-					m_completedJobs.erase(m_completedJobs.begin() + i);
-					jobToRetrived->m_state = JobState::RETRIEVED;
-					m_completedJobsMutex.unlock();
-					return jobToRetrived;
-				}
-			}
+			return nullptr;
 		}
-		else
+
+		// COMPLETED is set just before the push, so the job can be a few instructions away from the stack
+		m_completedJobsMutex.lock();
+		DrainIncomingCompletedJobs();
+		while (!jobToRetrived->m_isInCompletedList)
 		{
-			Job* firstFinishedJob = m_completedJobs.front();
-			m_completedJobs.pop_front();
 			m_completedJobsMutex.unlock();
-			return firstFinishedJob;
+			std::this_thread::yield();
+			m_completedJobsMutex.lock();
+			DrainIncomingCompletedJobs();
 		}
+		UnlinkCompletedJob(jobToRetrived);
+		m_completedJobsMutex.unlock();
+		return jobToRetrived;
 	}
 
+	m_completedJobsMutex.lock();
+	DrainIncomingCompletedJobs();
+	Job* firstFinishedJob = m_completedJobsHead;
+	if (firstFinishedJob)
+	{
+		UnlinkCompletedJob(firstFinishedJob);
+	}
 	m_completedJobsMutex.unlock();
-	return nullptr;
+	return firstFinishedJob;
 }
 
 size_t JobSystem::GetNumQueuedJobs() const
 {
-	m_queuedJobsMutex.lock();
-	size_t numQueuedJob = m_queuedJobs.size();
-	m_queuedJobsMutex.unlock();
-	return numQueuedJob;
+	return m_numQueuedJobs;
+}
+
+size_t JobSystem::GetNumQueuedJobs(JobPriority priority) const
+{
+	return m_numQueuedJobsByPriority[(int)priority];
 }
 
 size_t JobSystem::GetNumCompletedJobs() const
 {
-	m_completedJobsMutex.lock();
-	size_t numCompletedJob = m_completedJobs.size();
-	m_completedJobsMutex.unlock();
-	return numCompletedJob;
+	return m_numCompletedJobs;
 }
 
-void JobSystem::ClearAllJobs()
+int JobSystem::GetNumWorkers() const
 {
-	m_queuedJobsMutex.lock();
-	m_executingJobsMutex.lock();
-	m_completedJobsMutex.lock();
+	return (int)m_workers.size();
+}
 
-	for (size_t i = 0; i < m_queuedJobs.size(); i++)
+int JobSystem::GetNumParallelParticipants(int begin, int end, int grainSize) const
+{
+	if (end <= begin)
 	{
-		delete m_queuedJobs[i];
+		return 1;
 	}
-	for (size_t i = 0; i < m_executingJobs.size(); i++)
+	if (grainSize < 1)
 	{
-		delete m_executingJobs[i];
+		grainSize = 1;
 	}
-	for (size_t i = 0; i < m_completedJobs.size(); i++)
+
+	// One job per worker at most; the chunk counter balances the load, not the job count
+	int numChunks = (int)(((long long)end - (long long)begin + grainSize - 1) / grainSize);
+	int numJobs = numChunks - 1;
+	if (numJobs > (int)m_workers.size())
 	{
-		delete m_completedJobs[i];
+		numJobs = (int)m_workers.size();
 	}
-
-	m_queuedJobs.clear();
-	m_executingJobs.clear();
-	m_completedJobs.clear();
-
-	m_queuedJobsMutex.unlock();
-	m_executingJobsMutex.unlock();
-	m_completedJobsMutex.unlock();
+	if (numJobs > MAX_PARALLEL_FOR_JOBS)
+	{
+		numJobs = MAX_PARALLEL_FOR_JOBS;
+	}
+	return numJobs + 1;
 }
 
-void JobSystem::SetWorkerThreadJobFlags(unsigned int bitflags, int num)
+// UNTRACKED jobs belong to a caller that is blocked in WaitForJob, often on its own stack, so they stay queued
+// and run as usual. Everything else is released; the caller holds the lock for the queue
+size_t JobSystem::ReleaseQueuedJobs(JobQueue& jobs)
 {
-	int tracker = num;
+	// Cycle through the queue once, putting the kept jobs back in their original order
+	size_t numJobs = jobs.GetSize();
+	size_t numReleased = 0;
+	for (size_t i = 0; i < numJobs; i++)
+	{
+		Job* job = jobs.PopFront();
+		if (job->m_completionPolicy == JobCompletionPolicy::UNTRACKED)
+		{
+			jobs.PushBack(job);
+		}
+		else
+		{
+			ReleaseJob(job);
+			numReleased++;
+		}
+	}
+	return numReleased;
+}
 
-	for (size_t i = 0; i < m_workers.size(); i++)
+void JobSystem::ClearAllJobs()
+{
+	// Executing jobs can't be pulled out from under a worker, and a finishing one can still queue its continuations.
+	// So let them land first, then sweep, and go again until a sweep finds nothing to release and nothing running
+	for (;;)
 	{
-		if (m_workers[i]->m_jobTypeBitflags == 1)
+		while (m_numExecutingJobs > 0)
 		{
-			m_workers[i]->m_jobTypeBitflags = bitflags;
-			tracker--;
-			if (tracker <= 0)
-			{
-				return;
-			}
+			std::this_thread::yield();
+		}
+		if (ReleaseAllQueuedJobs() == 0 && m_numExecutingJobs == 0)
+		{
+			break;
 		}
 	}
 
+	m_completedJobsMutex.lock();
+	DrainIncomingCompletedJobs();
+	while (m_completedJobsHead)
+	{
+		Job* job = m_completedJobsHead;
+		UnlinkCompletedJob(job);
+		ReleaseJob(job);
+	}
+	m_completedJobsMutex.unlock();
+}
+
+size_t JobSystem::ReleaseAllQueuedJobs()
+{
+	size_t numReleasedTotal = 0;
+	for (size_t i = 0; i < m_workers.size(); i++)
+	{
+		JobWorker* worker = m_workers[i];
+		worker->m_localJobsMutex.lock();
+		for (int priority = 0; priority < NUM_JOB_PRIORITIES; priority++)
+		{
+			size_t numReleased = ReleaseQueuedJobs(worker->m_localJobs[priority]);
+			m_numQueuedJobs -= numReleased;
+			m_numQueuedJobsByPriority[priority] -= numReleased;
+			numReleasedTotal += numReleased;
+		}
+		worker->m_localJobsMutex.unlock();
+	}
+
+	m_queuedJobsMutex.lock();
+	for (int priority = 0; priority < NUM_JOB_PRIORITIES; priority++)
+	{
+		size_t numReleased = ReleaseQueuedJobs(m_queuedJobs[priority]);
+		m_numQueuedJobs -= numReleased;
+		m_numQueuedJobsByPriority[priority] -= numReleased;
+		m_numSharedQueuedJobs[priority] = m_queuedJobs[priority].GetSize();
+		numReleasedTotal += numReleased;
+	}
+	m_queuedJobsMutex.unlock();
+	return numReleasedTotal;
+}
+
+void JobSystem::SetWorkerThreadJobFlags(unsigned int bitflags, int num)
+{
+	int tracker = num;
+
+	for (size_t i = 0; i < m_workers.size(); i++)
+	{
+		if (m_workers[i]->m_jobTypeBitflags == 1)
+		{
+			m_workers[i]->m_jobTypeBitflags = bitflags;
+			tracker--;
+			if (tracker <= 0)
+			{
+				break;
+			}
+		}
+	}
+
+	// Parked workers may now accept jobs that were sitting in the shared queue or in another deque
+	WakeAllWorkers();
+}
+
+bool JobSystem::ShouldYieldToFrame() const
+{
+	return m_isInFrame && m_config.m_frameBudgetSeconds > 0.0 && GetFrameTimeRemaining() < m_config.m_backgroundCutoffSeconds;
+}
+
+double JobSystem::GetFrameTimeRemaining() const
+{
+	if (!m_isInFrame || m_config.m_frameBudgetSeconds <= 0.0)
+	{
+		return m_config.m_frameBudgetSeconds;
+	}
+	return m_frameStartSeconds + m_config.m_frameBudgetSeconds - GetCurrentTimeSeconds();
+}
+
+Job* JobSystem::ClaimJob(JobWorker* worker, bool isFinalCheck, bool ignoresFrameDeadline)
+{
+	// Highest priority first across the whole system, so a worker steals critical work before running its own normal jobs.
+	// Levels with nothing queued are skipped without touching a lock
+	Job* job = nullptr;
+	for (int priority = 0; priority < NUM_JOB_PRIORITIES && !job; priority++)
+	{
+		if (m_numQueuedJobsByPriority[priority] == 0)
+		{
+			continue;
+		}
+		if (priority == (int)JobPriority::BACKGROUND && !ignoresFrameDeadline && ShouldYieldToFrame())
+		{
+			break;
+		}
+
+		job = worker->PopLocalJob(priority);
+		if (!job && m_numSharedQueuedJobs[priority] > 0)
+		{
+			job = ClaimSharedJob(worker->m_jobTypeBitflags, priority);
+		}
+		if (!job)
+		{
+			if (m_isCollectingStats)
+			{
+				double stealStartSeconds = GetCurrentTimeSeconds();
+				job = StealJob(worker, priority, isFinalCheck);
+				worker->m_stealSeconds.store(worker->m_stealSeconds.load(std::memory_order_relaxed) + GetCurrentTimeSeconds() - stealStartSeconds, std::memory_order_relaxed);
+				if (job)
+				{
+					worker->m_numJobsStolen.fetch_add(1, std::memory_order_relaxed);
+				}
+			}
+			else
+			{
+				job = StealJob(worker, priority, isFinalCheck);
+			}
+		}
+	}
+
+	if (job)
+	{
+		MarkJobExecuting(job);
+	}
+
+	return job;
+}
+
+JobWorker* JobSystem::FindWorkerForJob(Job const* job)
+{
+	if (m_workers.empty())
+	{
+		return nullptr;
+	}
+
+	// Round-robin over the workers whose bitflags accept this job type
+	unsigned int numWorkers = (unsigned int)m_workers.size();
+	unsigned int startIndex = m_nextWorkerIndex++;
+	for (unsigned int i = 0; i < numWorkers; i++)
+	{
+		JobWorker* worker = m_workers[(startIndex + i) % numWorkers];
+		if (worker->CanExecute(job))
+		{
+			return worker;
+		}
+	}
+
+	return nullptr;
+}
+
+Job* JobSystem::ClaimSharedJob(unsigned int bitflags, int priority)
+{
+	m_queuedJobsMutex.lock();
+	JobQueue& queuedJobs = m_queuedJobs[priority];
+
+	// Skip over jobs this worker cannot run instead of stalling on the head of the queue
+	for (size_t i = 0; i < queuedJobs.GetSize(); i++)
+	{
+		Job* job = queuedJobs.GetJob(i);
+		if ((job->m_Bitflags & bitflags) != 0)
+		{
+			queuedJobs.Erase(i);
+			m_numSharedQueuedJobs[priority]--;
+			m_queuedJobsMutex.unlock();
+			return job;
+		}
+	}
+
+	m_queuedJobsMutex.unlock();
+	return nullptr;
+}
+
+Job* JobSystem::StealJob(JobWorker* thief, int priority, bool isFinalCheck)
+{
+	unsigned int numWorkers = (unsigned int)m_workers.size();
+	if (numWorkers <= 1)
+	{
+		return nullptr;
+	}
+
+	// Rotate the first victim so idle workers spread out instead of all hammering worker 0
+	unsigned int startIndex = thief->m_stealCursor++;
+	for (unsigned int i = 0; i < numWorkers; i++)
+	{
+		JobWorker* victim = m_workers[(startIndex + i) % numWorkers];
+		if (victim == thief)
+		{
+			continue;
+		}
+
+		Job* job = victim->StealJob(thief->m_jobTypeBitflags, priority, isFinalCheck);
+		if (job)
+		{
+			return job;
+		}
+	}
+
+	return nullptr;
+}
+
+void JobSystem::MarkJobExecuting(Job* job)
+{
+	m_numQueuedJobs--;
+	m_numQueuedJobsByPriority[(int)job->m_priority]--;
+	m_numExecutingJobs++;
+	job->m_state = JobState::EXECUTING;
+}
+
+void JobSystem::WakeWorkerForJob(unsigned int jobBitflags, JobWorker* targetWorker)
+{
+	// Pairs with the increment in ParkUntilWoken: either that worker's final check sees the pushed job
+	// or this read sees the worker parked
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (m_numParkedWorkers == 0)
+	{
+		return;
+	}
+
+	if (targetWorker->m_isParked)
+	{
+		targetWorker->Wake();
+		return;
+	}
+
+	// The owner is busy, so wake one idle worker that can run the job and let it steal
+	for (size_t i = 0; i < m_workers.size(); i++)
+	{
+		JobWorker* worker = m_workers[i];
+		if (worker->m_isParked && (worker->m_jobTypeBitflags & jobBitflags) != 0)
+		{
+			worker->Wake();
+			return;
+		}
+	}
+}
+
+void JobSystem::WakeAllWorkers()
+{
+	for (size_t i = 0; i < m_workers.size(); i++)
+	{
+		m_workers[i]->Wake();
+	}
+}
+
+void JobSystem::ReleaseContinuations(Job* job)
+{
+	// Once m_hasFinished is set AddDependency stops appending, so the list can be walked without the lock
+	job->m_continuationsMutex.lock();
+	job->m_hasFinished = true;
+	job->m_continuationsMutex.unlock();
+
+	job->m_numPendingDependencies = 1;
+
+	for (size_t i = 0; i < job->m_continuations.size(); i++)
+	{
+		Job* continuation = job->m_continuations[i];
+		if (continuation->m_numPendingDependencies.fetch_sub(1) == 1)
+		{
+			ScheduleJob(continuation);
+		}
+	}
+	job->m_continuations.clear();
+}
+
+void JobSystem::ResetForReuse(Job* job)
+{
+	// A retrieved job may be queued again, so later AddDependency calls have to wait for its next run
+	job->m_continuationsMutex.lock();
+	job->m_hasFinished = false;
+	job->m_continuationsMutex.unlock();
+}
+
+Job* JobSystem::ClaimJobForHelper(unsigned int bitflags)
+{
+	Job* job = nullptr;
+	for (int priority = 0; priority < NUM_JOB_PRIORITIES && !job; priority++)
+	{
+		if (m_numQueuedJobsByPriority[priority] == 0)
+		{
+			continue;
+		}
+		if (m_numSharedQueuedJobs[priority] > 0)
+		{
+			job = ClaimSharedJob(bitflags, priority);
+		}
+		for (size_t i = 0; i < m_workers.size() && !job; i++)
+		{
+			job = m_workers[i]->StealJob(bitflags, priority, false);
+		}
+	}
+
+	if (job)
+	{
+		MarkJobExecuting(job);
+	}
+
+	return job;
+}
+
+void JobSystem::DrainIncomingCompletedJobs()
+{
+	// Called with m_completedJobsMutex held. The stack is newest first, so reverse it to keep completion order
+	Job* incoming = m_incomingCompletedJobs.exchange(nullptr);
+	Job* reversed = nullptr;
+	while (incoming)
+	{
+		Job* next = incoming->m_nextCompletedJob;
+		incoming->m_nextCompletedJob = reversed;
+		reversed = incoming;
+		incoming = next;
+	}
+
+	while (reversed)
+	{
+		Job* job = reversed;
+		reversed = reversed->m_nextCompletedJob;
+
+		job->m_prevCompletedJob = m_completedJobsTail;
+		job->m_nextCompletedJob = nullptr;
+		if (m_completedJobsTail)
+		{
+			m_completedJobsTail->m_nextCompletedJob = job;
+		}
+		else
+		{
+			m_completedJobsHead = job;
+		}
+		m_completedJobsTail = job;
+		job->m_isInCompletedList = true;
+	}
+}
+
+void JobSystem::UnlinkCompletedJob(Job* job)
+{
+	// Called with m_completedJobsMutex held
+	if (job->m_prevCompletedJob)
+	{
+		job->m_prevCompletedJob->m_nextCompletedJob = job->m_nextCompletedJob;
+	}
+	else
+	{
+		m_completedJobsHead = job->m_nextCompletedJob;
+	}
+	if (job->m_nextCompletedJob)
+	{
+		job->m_nextCompletedJob->m_prevCompletedJob = job->m_prevCompletedJob;
+	}
+	else
+	{
+		m_completedJobsTail = job->m_prevCompletedJob;
+	}
+
+	job->m_prevCompletedJob = nullptr;
+	job->m_nextCompletedJob = nullptr;
+	job->m_isInCompletedList = false;
+	job->m_state = JobState::RETRIEVED;
+	m_numCompletedJobs--;
+	ResetForReuse(job);
+}
+
+bool JobSystem::HelpWithQueuedJob()
+{
+	JobWorker* worker = s_currentWorker;
+	if (worker && worker->m_system != this)
+	{
+		worker = nullptr;
+	}
+	return HelpWithQueuedJob(worker);
+}
+
+bool JobSystem::HelpWithQueuedJob(JobWorker* worker)
+{
+	// A waiting thread ignores the frame deadline, the job it waits on may well be a background one
+	Job* jobToExecute = worker ? ClaimJob(worker, false, true) : ClaimJobForHelper(1);
+	if (!jobToExecute)
+	{
+		return false;
+	}
+
+	ExecuteJob(jobToExecute, worker);
+	return true;
+}
+
+void JobSystem::ExecuteJob(Job* job, JobWorker* worker)
+{
+	if (!m_isCollectingStats)
+	{
+		job->Execute();
+		CompleteJob(job);
+		return;
+	}
+
+	double startSeconds = GetCurrentTimeSeconds();
+	job->Execute();
+	double endSeconds = GetCurrentTimeSeconds();
+
+	// Before CompleteJob, which may release the job
+	RecordExecutedJob(job, worker, startSeconds, endSeconds);
+	CompleteJob(job);
+}
+
+void JobSystem::RecordExecutedJob(Job const* job, JobWorker* worker, double startSeconds, double endSeconds)
+{
+	JobTimelineEvent event;
+	event.m_lane = worker ? worker->m_id : (int)m_workers.size();
+	event.m_jobType = GetJobType(job->m_Bitflags);
+	event.m_priority = job->m_priority;
+	event.m_queuedSeconds = job->m_queuedSeconds;
+	event.m_startSeconds = startSeconds;
+	event.m_endSeconds = endSeconds;
+
+	double executeSeconds = endSeconds - startSeconds;
+	int type = event.m_jobType;
+	m_numJobsByType[type].fetch_add(1, std::memory_order_relaxed);
+	m_executeSecondsByType[type].fetch_add(executeSeconds, std::memory_order_relaxed);
+	m_executeHistograms[type][GetLatencyBucket(executeSeconds)].fetch_add(1, std::memory_order_relaxed);
+
+	// Jobs queued while stats were off have no queue time
+	if (event.m_queuedSeconds > 0.0)
+	{
+		double queueSeconds = startSeconds - event.m_queuedSeconds;
+		m_queueSecondsByType[type].fetch_add(queueSeconds, std::memory_order_relaxed);
+		m_queueToStartHistograms[type][GetLatencyBucket(queueSeconds)].fetch_add(1, std::memory_order_relaxed);
+	}
+
+	if (worker)
+	{
+		worker->m_busySeconds.store(worker->m_busySeconds.load(std::memory_order_relaxed) + executeSeconds, std::memory_order_relaxed);
+		worker->m_numJobsExecuted.fetch_add(1, std::memory_order_relaxed);
+		worker->m_timeline.AddEvent(event);
+	}
+	else
+	{
+		m_helperTimeline.AddEvent(event);
+	}
+}
+
+void JobSystem::SetCollectingStats(bool isCollectingStats)
+{
+	m_isCollectingStats = isCollectingStats;
+}
+
+bool JobSystem::IsCollectingStats() const
+{
+	return m_isCollectingStats;
+}
+
+void JobSystem::ResetStats()
+{
+	// Counters are zeroed while workers may be adding to them, so the first snapshot after a reset can be off by a job or two
+	for (size_t i = 0; i < m_workers.size(); i++)
+	{
+		m_workers[i]->m_busySeconds = 0.0;
+		m_workers[i]->m_stealSeconds = 0.0;
+		m_workers[i]->m_numJobsExecuted = 0;
+		m_workers[i]->m_numJobsStolen = 0;
+	}
+
+	for (int type = 0; type < NUM_JOB_TYPES; type++)
+	{
+		m_numJobsByType[type] = 0;
+		m_queueSecondsByType[type] = 0.0;
+		m_executeSecondsByType[type] = 0.0;
+		for (int bucket = 0; bucket < NUM_JOB_LATENCY_BUCKETS; bucket++)
+		{
+			m_queueToStartHistograms[type][bucket] = 0;
+			m_executeHistograms[type][bucket] = 0;
+		}
+	}
+
+	m_statsStartSeconds = GetCurrentTimeSeconds();
+}
+
+JobWorkerStats JobSystem::GetWorkerStats(int workerIndex) const
+{
+	JobWorkerStats stats;
+	if (workerIndex < 0 || workerIndex >= (int)m_workers.size())
+	{
+		return stats;
+	}
+
+	JobWorker const* worker = m_workers[workerIndex];
+	stats.m_busySeconds = worker->m_busySeconds;
+	stats.m_stealSeconds = worker->m_stealSeconds;
+	stats.m_numJobsExecuted = worker->m_numJobsExecuted;
+	stats.m_numJobsStolen = worker->m_numJobsStolen;
+
+	stats.m_idleSeconds = GetCurrentTimeSeconds() - m_statsStartSeconds - stats.m_busySeconds - stats.m_stealSeconds;
+	if (stats.m_idleSeconds < 0.0)
+	{
+		stats.m_idleSeconds = 0.0;
+	}
+	return stats;
+}
+
+JobTypeStats JobSystem::GetJobTypeStats(int jobType) const
+{
+	JobTypeStats stats;
+	if (jobType < 0 || jobType >= NUM_JOB_TYPES)
+	{
+		return stats;
+	}
+
+	stats.m_numJobs = m_numJobsByType[jobType];
+	stats.m_totalQueueSeconds = m_queueSecondsByType[jobType];
+	stats.m_totalExecuteSeconds = m_executeSecondsByType[jobType];
+	for (int bucket = 0; bucket < NUM_JOB_LATENCY_BUCKETS; bucket++)
+	{
+		stats.m_queueToStartHistogram[bucket] = m_queueToStartHistograms[jobType][bucket];
+		stats.m_executeHistogram[bucket] = m_executeHistograms[jobType][bucket];
+	}
+	return stats;
+}
+
+void JobSystem::GetTimelineEvents(int numFramesAgo, std::vector<JobTimelineEvent>& out_events) const
+{
+	double sinceSeconds = GetFrameStartSeconds(numFramesAgo);
+
+	for (int lane = 0; lane <= (int)m_workers.size(); lane++)
+	{
+		JobTimeline const& timeline = (lane < (int)m_workers.size()) ? m_workers[lane]->m_timeline : m_helperTimeline;
+		timeline.m_mutex.lock();
+		size_t numEvents = (timeline.m_numEventsAdded < JOB_TIMELINE_CAPACITY) ? timeline.m_numEventsAdded : JOB_TIMELINE_CAPACITY;
+		for (size_t i = timeline.m_numEventsAdded - numEvents; i < timeline.m_numEventsAdded; i++)
+		{
+			JobTimelineEvent const& event = timeline.m_events[i % JOB_TIMELINE_CAPACITY];
+			if (event.m_startSeconds >= sinceSeconds)
+			{
+				out_events.push_back(event);
+			}
+		}
+		timeline.m_mutex.unlock();
+	}
+}
+
+double JobSystem::GetFrameStartSeconds(int numFramesAgo) const
+{
+	if (numFramesAgo < 0 || numFramesAgo >= m_numFramesStarted || numFramesAgo >= JOB_FRAME_HISTORY)
+	{
+		return 0.0;
+	}
+	return m_frameStartHistory[(m_numFramesStarted - 1 - numFramesAgo) % JOB_FRAME_HISTORY];
+}
+
+int JobSystem::GetJobType(unsigned int bitflags)
+{
+	for (int type = 0; type < NUM_JOB_TYPES; type++)
+	{
+		if ((bitflags & (1u << type)) != 0)
+		{
+			return type;
+		}
+	}
+	return 0;
+}
+
+int JobSystem::GetLatencyBucket(double seconds)
+{
+	unsigned long long microseconds = (seconds > 0.0) ? (unsigned long long)(seconds * 1000000.0) : 0;
+	int bucket = 0;
+	while (microseconds > 0 && bucket < NUM_JOB_LATENCY_BUCKETS - 1)
+	{
+		microseconds >>= 1;
+		bucket++;
+	}
+	return bucket;
+}
+
+FunctionJob* JobSystem::AllocatePooledJob()
+{
+	m_jobPoolMutex.lock();
+	if (m_freePooledJobs.empty())
+	{
+		AddJobPoolBlock();
+	}
+	FunctionJob* job = m_freePooledJobs.back();
+	m_freePooledJobs.pop_back();
+	m_jobPoolMutex.unlock();
+	return job;
+}
+
+void JobSystem::FreePooledJob(FunctionJob* job)
+{
+	job->ClearFunction();
+
+	// Back to what a freshly constructed job looks like; the continuation vector keeps its capacity
+	job->m_Bitflags = 1;
+	job->m_state = JobState::NEW;
+	job->m_completionPolicy = JobCompletionPolicy::RETRIEVE;
+	job->m_priority = JobPriority::NORMAL;
+	job->m_numPendingDependencies = 1;
+	job->m_nextCompletedJob = nullptr;
+	job->m_prevCompletedJob = nullptr;
+	job->m_isInCompletedList = false;
+
+	// AddDependencyIfPending reads these together under the lock, it must never see the new state with the old generation
+	job->m_continuationsMutex.lock();
+	job->m_continuations.clear();
+	job->m_hasFinished = false;
+	job->m_generation++;
+	job->m_continuationsMutex.unlock();
+
+	m_jobPoolMutex.lock();
+	m_freePooledJobs.push_back(job);
+	m_jobPoolMutex.unlock();
+}
+
+void JobSystem::AddJobPoolBlock()
+{
+	// Called with m_jobPoolMutex held
+	int blockIndex = m_numJobPoolBlocks;
+	GUARANTEE_OR_DIE(blockIndex < MAX_JOB_POOL_BLOCKS, "Job pool is full, jobs are probably not being released");
+
+	FunctionJob* block = new FunctionJob[JOB_POOL_BLOCK_SIZE];
+	for (int i = 0; i < JOB_POOL_BLOCK_SIZE; i++)
+	{
+		block[i].m_poolIndex = (unsigned int)(blockIndex * JOB_POOL_BLOCK_SIZE + i);
+	}
+	m_jobPoolBlocks[blockIndex] = block;
+
+	// Reserve for every slot up front so releasing a job never reallocates the free list
+	m_freePooledJobs.reserve((size_t)(blockIndex + 1) * JOB_POOL_BLOCK_SIZE);
+	for (int i = JOB_POOL_BLOCK_SIZE - 1; i >= 0; i--)
+	{
+		m_freePooledJobs.push_back(&block[i]);
+	}
+	m_numJobPoolBlocks = blockIndex + 1;
+}
+
+void JobSystem::DestroyJobPool()
+{
+	m_jobPoolMutex.lock();
+	int numBlocks = m_numJobPoolBlocks;
+	m_numJobPoolBlocks = 0;
+	for (int i = 0; i < numBlocks; i++)
+	{
+		delete[] m_jobPoolBlocks[i];
+		m_jobPoolBlocks[i] = nullptr;
+	}
+	m_freePooledJobs.clear();
+	m_jobPoolMutex.unlock();
+}
+
+void FunctionJob::ClearFunction()
+{
+	if (m_destroy)
+	{
+		m_destroy(m_storage);
+	}
+	m_invoke = nullptr;
+	m_destroy = nullptr;
 }
@@ -1,21 +1,109 @@
 #pragma once
 #include <vector>
-#include <deque>
 #include <mutex>
 #include <atomic>
 #include <thread>
+#include <condition_variable>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+class JobSystem;
 
 enum class JobState
 {
 	NEW,
+	WAITING,
 	QUEUED,
 	EXECUTING,
 	COMPLETED,
 	RETRIEVED
 };
+enum class JobCompletionPolicy
+{
+	RETRIEVE,		// Kept in the completed list until RetrieveJob hands it back
+	AUTO_RELEASE,	// Released by the JobSystem as soon as it completes, for graph nodes nobody retrieves
+	UNTRACKED		// Owned by the caller, who waits on it with WaitForJob; never touched again once COMPLETED
+};
+enum class JobPriority
+{
+	CRITICAL,		// Needed later this frame, e.g. render prep
+	NORMAL,
+	BACKGROUND,		// Asset loads, AI lookahead; not started once the frame is close to its deadline
+	NUM
+};
+constexpr int NUM_JOB_PRIORITIES = (int)JobPriority::NUM;
+
+constexpr int MAX_PARALLEL_FOR_JOBS = 63;
+constexpr int MAX_PARALLEL_FOR_PARTICIPANTS = MAX_PARALLEL_FOR_JOBS + 1;	// Jobs plus the calling thread
+
+constexpr int JOB_FUNCTION_STORAGE_SIZE = 64;	// Bytes of captures a pooled job can hold inline
+constexpr int JOB_POOL_BLOCK_SIZE = 256;
+constexpr int MAX_JOB_POOL_BLOCKS = 256;
+constexpr unsigned int INVALID_JOB_POOL_INDEX = 0xFFFFFFFF;
+
+constexpr int NUM_JOB_TYPES = 32;				// One per bit of Job::m_Bitflags, stats file a job under its lowest set bit
+constexpr int NUM_JOB_LATENCY_BUCKETS = 24;		// Bucket 0 is under 1us, bucket i covers [2^(i-1), 2^i) us
+constexpr int JOB_TIMELINE_CAPACITY = 2048;		// Executed jobs each thread remembers for timeline export
+constexpr int JOB_FRAME_HISTORY = 128;
+constexpr int JOB_QUEUE_INITIAL_CAPACITY = 256;	// Per queue, a power of two; grows by doubling and never shrinks
+
+// Refers to a pooled job; goes stale once the job is released, even if its slot is reused by a new job
+struct JobHandle
+{
+	unsigned int m_index = INVALID_JOB_POOL_INDEX;
+	unsigned int m_generation = 0;
+
+	bool IsValid() const { return m_index != INVALID_JOB_POOL_INDEX; }
+};
+
 struct JobSystemConfig
 {
 	int m_numWorkers = -1;
+	int m_numSpinsBeforeSleep = 64;	// Idle passes a worker makes (yielding in between) before it parks
+	int m_numPreallocatedJobs = JOB_POOL_BLOCK_SIZE;	// Pooled jobs created at Startup, the pool grows by blocks past this
+	double m_frameBudgetSeconds = 0.0;			// Time from BeginFrame to the frame deadline, 0 means no deadline
+	double m_backgroundCutoffSeconds = 0.002;	// Background jobs don't start with less than this left before the deadline
+	bool m_collectStats = false;				// Timing for GetWorkerStats, GetJobTypeStats and the timeline; timer reads and shared counters per job, roughly halves throughput
+};
+
+struct JobWorkerStats
+{
+	double m_busySeconds = 0.0;		// Executing jobs
+	double m_stealSeconds = 0.0;	// Looking through other workers' deques
+	double m_idleSeconds = 0.0;		// Everything else since the stats were reset, spinning and parked included
+	unsigned int m_numJobsExecuted = 0;
+	unsigned int m_numJobsStolen = 0;
+};
+
+struct JobTypeStats
+{
+	unsigned int m_numJobs = 0;
+	double m_totalQueueSeconds = 0.0;
+	double m_totalExecuteSeconds = 0.0;
+	unsigned int m_queueToStartHistogram[NUM_JOB_LATENCY_BUCKETS] = {};
+	unsigned int m_executeHistogram[NUM_JOB_LATENCY_BUCKETS] = {};
+};
+
+struct JobTimelineEvent
+{
+	int m_lane = 0;		// Worker index, or the number of workers for jobs run by a waiting thread
+	int m_jobType = 0;
+	JobPriority m_priority = JobPriority::NORMAL;
+	double m_queuedSeconds = 0.0;
+	double m_startSeconds = 0.0;
+	double m_endSeconds = 0.0;
+};
+
+// Ring of the most recently executed jobs on one thread
+struct JobTimeline
+{
+	void AddEvent(JobTimelineEvent const& event);
+
+	JobTimelineEvent m_events[JOB_TIMELINE_CAPACITY];
+	size_t m_numEventsAdded = 0;
+	mutable std::mutex m_mutex;
 };
 
 struct Job
@@ -26,6 +114,106 @@ struct Job
 	virtual void Execute() = 0;
 	std::atomic<unsigned int> m_Bitflags = 1;
 	std::atomic<JobState> m_state = JobState::NEW;
+	JobCompletionPolicy m_completionPolicy = JobCompletionPolicy::RETRIEVE;
+	JobPriority m_priority = JobPriority::NORMAL;
+
+private:
+	friend class JobSystem;
+
+	// Unfinished prerequisites plus one held by QueueJob, the job is scheduled when this reaches zero
+	std::atomic<int> m_numPendingDependencies = 1;
+	std::vector<Job*> m_continuations;
+	std::mutex m_continuationsMutex;
+	bool m_hasFinished = false;
+
+	// Intrusive links for the completed list, so completing and retrieving a job never searches
+	Job* m_nextCompletedJob = nullptr;
+	Job* m_prevCompletedJob = nullptr;
+	bool m_isInCompletedList = false;
+
+	unsigned int m_poolIndex = INVALID_JOB_POOL_INDEX;
+	double m_queuedSeconds = 0.0;
+};
+
+// Job running a callable stored inline, created by JobSystem::CreateJob out of the job pool
+struct FunctionJob : public Job
+{
+	virtual void Execute() override { m_invoke(m_storage); }
+
+private:
+	friend class JobSystem;
+
+	template <typename Function>
+	void SetFunction(Function&& function);
+	void ClearFunction();
+
+	alignas(std::max_align_t) unsigned char m_storage[JOB_FUNCTION_STORAGE_SIZE];
+	void (*m_invoke)(void* storage) = nullptr;
+	void (*m_destroy)(void* storage) = nullptr;
+	std::atomic<unsigned int> m_generation = 0;
+};
+
+
+// Index range shared by every participant of one parallel call; chunks are handed out first come first served
+struct ParallelRange
+{
+	int m_begin = 0;
+	int m_end = 0;
+	int m_grainSize = 1;
+	int m_numChunks = 0;
+	std::atomic<int> m_nextChunk = 0;
+
+	template <typename RangeFunction>
+	void RunChunks(RangeFunction const& function, int participantIndex)
+	{
+		for (int chunk = m_nextChunk++; chunk < m_numChunks; chunk = m_nextChunk++)
+		{
+			int chunkBegin = m_begin + chunk * m_grainSize;
+			int chunkEnd = (m_end - chunkBegin > m_grainSize) ? chunkBegin + m_grainSize : m_end;
+			function(chunkBegin, chunkEnd, participantIndex);
+		}
+	}
+};
+
+// Ring of queued jobs in order. The buffer only grows, so once every queue has seen its peak backlog
+// pushing and erasing never touch the heap. Not thread safe, the owner holds the lock for it
+class JobQueue
+{
+public:
+	JobQueue();
+	~JobQueue();
+	JobQueue(JobQueue const& copy) = delete;
+	JobQueue& operator=(JobQueue const& copy) = delete;
+
+	size_t GetSize() const { return m_size; }
+	bool IsEmpty() const { return m_size == 0; }
+	Job* GetJob(size_t index) const { return m_jobs[(m_head + index) & (m_capacity - 1)]; }
+
+	void PushBack(Job* job);
+	Job* PopFront();
+	void Erase(size_t index);	// Keeps the order, shifting whichever side of index is shorter
+
+private:
+	void Grow();
+
+	Job** m_jobs = nullptr;
+	size_t m_capacity = 0;
+	size_t m_head = 0;
+	size_t m_size = 0;
+};
+
+
+template <typename RangeFunction>
+struct ParallelRangeJob : public Job
+{
+	// The calling thread is already blocked on these, so they jump ahead of ordinary work
+	ParallelRangeJob() { m_completionPolicy = JobCompletionPolicy::UNTRACKED; m_priority = JobPriority::CRITICAL; }
+
+	virtual void Execute() override { m_range->RunChunks(*m_function, m_participantIndex); }
+
+	ParallelRange* m_range = nullptr;
+	RangeFunction const* m_function = nullptr;
+	int m_participantIndex = 0;
 };
 
 
@@ -36,13 +224,40 @@ class JobWorker
 	JobWorker(int id, JobSystem* system);
 	~JobWorker();
 
+	void StartThread();
+	void JoinThread();
 	void ThreadMain();
+	Job* ParkUntilWoken();
+	void Wake();
+
+	// Owner end of the deque (back), only the owning worker and external producers push here
+	void PushLocalJob(Job* job);
+	Job* PopLocalJob(int priority);
+	// Thief end of the deque (front), used by other workers when they run out of work
+	Job* StealJob(unsigned int thiefBitflags, int priority, bool canBlock);
+	bool CanExecute(Job const* job) const;
 
 private:
 	int m_id = -1;
 	std::atomic<unsigned int> m_jobTypeBitflags = 1;
 	JobSystem* m_system = nullptr;
 	std::thread* m_thread = nullptr;
+
+	JobQueue m_localJobs[NUM_JOB_PRIORITIES];
+	mutable std::mutex m_localJobsMutex;
+	unsigned int m_stealCursor = 0;
+
+	std::atomic<bool> m_isParked = false;
+	bool m_hasWakeSignal = false;
+	std::mutex m_wakeMutex;
+	std::condition_variable m_wakeCondition;
+
+	// Only the owning thread adds to these, JobSystem::GetWorkerStats reads them from anywhere
+	std::atomic<double> m_busySeconds = 0.0;
+	std::atomic<double> m_stealSeconds = 0.0;
+	std::atomic<unsigned int> m_numJobsExecuted = 0;
+	std::atomic<unsigned int> m_numJobsStolen = 0;
+	JobTimeline m_timeline;
 };
 
 class JobSystem
@@ -62,22 +277,296 @@ public:
 	void CreateWorkers(int num);
 	void DestroyWorkers();
 	void QueueJob(Job* jobToQueue);
+	void QueueJobAfter(Job* jobToQueue, std::vector<Job*> const& prerequisites);
+	void AddDependency(Job* job, Job* prerequisite);
+	// Also fine for a prerequisite that is already queued, AUTO_RELEASE included. False when it has finished or
+	// been released, and no dependency was added
+	bool AddDependencyIfPending(Job* job, JobHandle prerequisite);
+	void WaitForJob(Job* job);
+	void ReleaseJob(Job* job);
 	Job* ClaimJob(JobWorker* worker);
 	void CompleteJob(Job* jobToComplete);
 	Job* RetrieveJob(Job* jobToRetrived = nullptr);
 	size_t GetNumQueuedJobs() const;
+	size_t GetNumQueuedJobs(JobPriority priority) const;
 	size_t GetNumCompletedJobs() const;
+	int GetNumWorkers() const;
+
+	// Runs one queued job on the calling thread, false if there was nothing it could claim.
+	// For threads waiting on something the job system produces, so they help instead of sleeping
+	bool HelpWithQueuedJob();
+
+	// Instrumentation, see JobSystemCommands for the console side
+	void SetCollectingStats(bool isCollectingStats);
+	bool IsCollectingStats() const;
+	void ResetStats();
+	JobWorkerStats GetWorkerStats(int workerIndex) const;
+	JobTypeStats GetJobTypeStats(int jobType) const;
+	// Jobs that started after the start of the frame numFramesAgo frames back, oldest lane first
+	void GetTimelineEvents(int numFramesAgo, std::vector<JobTimelineEvent>& out_events) const;
+	double GetFrameStartSeconds(int numFramesAgo) const;	// 0 once the frame has dropped out of the history
+	static int GetJobType(unsigned int bitflags);
+	static int GetLatencyBucket(double seconds);
 
 	void ClearAllJobs();
 	void SetWorkerThreadJobFlags(unsigned int bitflags, int num);
 
+	// True between BeginFrame and EndFrame once the frame is inside its background cutoff.
+	// Long background jobs can poll this and split the rest of their work into a new job
+	bool ShouldYieldToFrame() const;
+	double GetFrameTimeRemaining() const;
+
+	// Pooled jobs, no heap allocation once the pool is warm. They go through QueueJob/RetrieveJob/ReleaseJob
+	// like any other job; ReleaseJob hands them back to the pool and makes their handles stale.
+	// function() must fit in JOB_FUNCTION_STORAGE_SIZE, capture by pointer or derive from Job otherwise
+	template <typename Function>
+	JobHandle CreateJob(Function&& function, unsigned int bitflags = 1, JobCompletionPolicy policy = JobCompletionPolicy::RETRIEVE, JobPriority priority = JobPriority::NORMAL);
+	template <typename Function>
+	JobHandle QueueFunction(Function&& function, unsigned int bitflags = 1, JobCompletionPolicy policy = JobCompletionPolicy::RETRIEVE, JobPriority priority = JobPriority::NORMAL);
+	Job* GetJob(JobHandle handle) const;	// nullptr once the job has been released
+	JobHandle GetHandle(Job const* job) const;	// Invalid handle for jobs that are not pooled
+	void QueueJob(JobHandle handle);
+	void WaitForJob(JobHandle handle);
+	void ReleaseJob(JobHandle handle);
+
+	// Parallel range primitives. The calling thread works on chunks too and they return once every index is done.
+	// function(int index)
+	template <typename Function>
+	void ParallelFor(int begin, int end, int grainSize, Function const& function);
+	// function(int rangeBegin, int rangeEnd), for loops that want to hoist work out of the per-index body
+	template <typename Function>
+	void ParallelForRange(int begin, int end, int grainSize, Function const& function);
+	// function(Element& element)
+	template <typename Container, typename Function>
+	void ParallelForEach(Container& container, int grainSize, Function const& function);
+	// out[i] = function(in[i]), out must already be at least as large as in
+	template <typename InputContainer, typename OutputContainer, typename Function>
+	void ParallelTransform(InputContainer const& in, OutputContainer& out, int grainSize, Function const& function);
+	// reduce(...reduce(identity, map(begin))..., map(end - 1)); reduce has to be associative and commutative
+	template <typename T, typename MapFunction, typename ReduceFunction>
+	T ParallelReduce(int begin, int end, int grainSize, T const& identity, MapFunction const& map, ReduceFunction const& reduce);
+
+	// function(int rangeBegin, int rangeEnd, int participantIndex), participantIndex < MAX_PARALLEL_FOR_PARTICIPANTS
+	template <typename RangeFunction>
+	void ParallelForParticipants(int begin, int end, int grainSize, RangeFunction const& function);
+
+private:
+	int GetNumParallelParticipants(int begin, int end, int grainSize) const;	// Calling thread plus the jobs a parallel call queues
+	size_t ReleaseQueuedJobs(JobQueue& jobs);
+	size_t ReleaseAllQueuedJobs();	// Every worker queue and the shared ones, for ClearAllJobs
+	JobWorker* FindWorkerForJob(Job const* job);
+	void ScheduleJob(Job* job);
+	void ReleaseContinuations(Job* job);
+	void ResetForReuse(Job* job);
+	void DrainIncomingCompletedJobs();
+	void UnlinkCompletedJob(Job* job);
+	Job* ClaimJob(JobWorker* worker, bool isFinalCheck, bool ignoresFrameDeadline);
+	Job* ClaimJobForHelper(unsigned int bitflags);
+	Job* ClaimSharedJob(unsigned int bitflags, int priority);
+	Job* StealJob(JobWorker* thief, int priority, bool isFinalCheck);
+	void WakeWorkerForJob(unsigned int jobBitflags, JobWorker* targetWorker);
+	void WakeAllWorkers();
+	void MarkJobExecuting(Job* job);
+	bool HelpWithQueuedJob(JobWorker* worker);
+	void ExecuteJob(Job* job, JobWorker* worker);
+	void RecordExecutedJob(Job const* job, JobWorker* worker, double startSeconds, double endSeconds);
+	FunctionJob* AllocatePooledJob();
+	void FreePooledJob(FunctionJob* job);
+	void AddJobPoolBlock();
+	void DestroyJobPool();
+
 private:
 	std::vector<JobWorker*> m_workers;
-	std::deque<Job*> m_queuedJobs;
-	std::deque<Job*> m_executingJobs;
-	std::deque<Job*> m_completedJobs;
+	std::atomic<unsigned int> m_nextWorkerIndex = 0;
+	std::atomic<size_t> m_numQueuedJobs = 0;
+	std::atomic<size_t> m_numQueuedJobsByPriority[NUM_JOB_PRIORITIES] = {};
+	std::atomic<int> m_numParkedWorkers = 0;
+
+	// Jobs that no worker's bitflags currently accept wait here instead of in a worker deque
+	JobQueue m_queuedJobs[NUM_JOB_PRIORITIES];
+	std::atomic<size_t> m_numSharedQueuedJobs[NUM_JOB_PRIORITIES] = {};
+
+	std::atomic<bool> m_isInFrame = false;
+	std::atomic<double> m_frameStartSeconds = 0.0;
+
+	// Stats, all of it is relaxed counting; only BeginFrame and the export touch the frame history
+	std::atomic<bool> m_isCollectingStats = false;
+	std::atomic<double> m_statsStartSeconds = 0.0;
+	std::atomic<unsigned int> m_numJobsByType[NUM_JOB_TYPES] = {};
+	std::atomic<double> m_queueSecondsByType[NUM_JOB_TYPES] = {};
+	std::atomic<double> m_executeSecondsByType[NUM_JOB_TYPES] = {};
+	std::atomic<unsigned int> m_queueToStartHistograms[NUM_JOB_TYPES][NUM_JOB_LATENCY_BUCKETS] = {};
+	std::atomic<unsigned int> m_executeHistograms[NUM_JOB_TYPES][NUM_JOB_LATENCY_BUCKETS] = {};
+	JobTimeline m_helperTimeline;
+	double m_frameStartHistory[JOB_FRAME_HISTORY] = {};
+	int m_numFramesStarted = 0;
+
+	std::atomic<size_t> m_numExecutingJobs = 0;
+
+	// Workers push completed jobs onto a lock-free stack; the retrieving side moves them into an
+	// ordered, doubly linked list under m_completedJobsMutex, which producers never take
+	std::atomic<Job*> m_incomingCompletedJobs = nullptr;
+	Job* m_completedJobsHead = nullptr;
+	Job* m_completedJobsTail = nullptr;
+	std::atomic<size_t> m_numCompletedJobs = 0;
+
 	mutable std::mutex m_queuedJobsMutex;
-	mutable std::mutex m_executingJobsMutex;
 	mutable std::mutex m_completedJobsMutex;
 	std::atomic<bool> m_isShuttingDown = false;
+
+	// Blocks are never moved or freed before Shutdown, so a handle's slot can be read without the lock
+	FunctionJob* m_jobPoolBlocks[MAX_JOB_POOL_BLOCKS] = {};
+	std::atomic<int> m_numJobPoolBlocks = 0;
+	std::vector<FunctionJob*> m_freePooledJobs;
+	std::mutex m_jobPoolMutex;
 };
+
+
+template <typename Function>
+void FunctionJob::SetFunction(Function&& function)
+{
+	using StoredFunction = std::decay_t<Function>;
+	static_assert(sizeof(StoredFunction) <= JOB_FUNCTION_STORAGE_SIZE, "Job function captures too much to be pooled");
+	static_assert(alignof(StoredFunction) <= alignof(std::max_align_t), "Job function is over-aligned");
+
+	new (m_storage) StoredFunction(std::forward<Function>(function));
+	m_invoke = [](void* storage) { (*static_cast<StoredFunction*>(storage))(); };
+	m_destroy = [](void* storage) { static_cast<StoredFunction*>(storage)->~StoredFunction(); };
+}
+
+template <typename Function>
+JobHandle JobSystem::CreateJob(Function&& function, unsigned int bitflags, JobCompletionPolicy policy, JobPriority priority)
+{
+	FunctionJob* job = AllocatePooledJob();
+	job->SetFunction(std::forward<Function>(function));
+	job->m_Bitflags = bitflags;
+	job->m_completionPolicy = policy;
+	job->m_priority = priority;
+
+	JobHandle handle;
+	handle.m_index = job->m_poolIndex;
+	handle.m_generation = job->m_generation;
+	return handle;
+}
+
+template <typename Function>
+JobHandle JobSystem::QueueFunction(Function&& function, unsigned int bitflags, JobCompletionPolicy policy, JobPriority priority)
+{
+	JobHandle handle = CreateJob(std::forward<Function>(function), bitflags, policy, priority);
+	QueueJob(handle);
+	return handle;
+}
+
+
+template <typename RangeFunction>
+void JobSystem::ParallelForParticipants(int begin, int end, int grainSize, RangeFunction const& function)
+{
+	if (end <= begin)
+	{
+		return;
+	}
+	if (grainSize < 1)
+	{
+		grainSize = 1;
+	}
+
+	ParallelRange range;
+	range.m_begin = begin;
+	range.m_end = end;
+	range.m_grainSize = grainSize;
+	range.m_numChunks = (int)(((long long)end - (long long)begin + grainSize - 1) / grainSize);
+	int numJobs = GetNumParallelParticipants(begin, end, grainSize) - 1;
+
+	// Only the jobs that get queued are constructed; each one carries a mutex and a continuation list
+	using RangeJob = ParallelRangeJob<RangeFunction>;
+	alignas(RangeJob) unsigned char jobStorage[MAX_PARALLEL_FOR_JOBS * sizeof(RangeJob)];
+	RangeJob* jobs = reinterpret_cast<RangeJob*>(jobStorage);
+	for (int i = 0; i < numJobs; i++)
+	{
+		RangeJob* job = new (&jobs[i]) RangeJob();
+		job->m_range = &range;
+		job->m_function = &function;
+		job->m_participantIndex = i + 1;
+		QueueJob(job);
+	}
+
+	range.RunChunks(function, 0);
+
+	for (int i = 0; i < numJobs; i++)
+	{
+		WaitForJob(&jobs[i]);
+		jobs[i].~RangeJob();
+	}
+}
+
+template <typename Function>
+void JobSystem::ParallelFor(int begin, int end, int grainSize, Function const& function)
+{
+	ParallelForParticipants(begin, end, grainSize, [&function](int rangeBegin, int rangeEnd, int)
+	{
+		for (int index = rangeBegin; index < rangeEnd; index++)
+		{
+			function(index);
+		}
+	});
+}
+
+template <typename Function>
+void JobSystem::ParallelForRange(int begin, int end, int grainSize, Function const& function)
+{
+	ParallelForParticipants(begin, end, grainSize, [&function](int rangeBegin, int rangeEnd, int)
+	{
+		function(rangeBegin, rangeEnd);
+	});
+}
+
+template <typename Container, typename Function>
+void JobSystem::ParallelForEach(Container& container, int grainSize, Function const& function)
+{
+	ParallelFor(0, (int)container.size(), grainSize, [&container, &function](int index)
+	{
+		function(container[index]);
+	});
+}
+
+template <typename InputContainer, typename OutputContainer, typename Function>
+void JobSystem::ParallelTransform(InputContainer const& in, OutputContainer& out, int grainSize, Function const& function)
+{
+	ParallelFor(0, (int)in.size(), grainSize, [&in, &out, &function](int index)
+	{
+		out[index] = function(in[index]);
+	});
+}
+
+template <typename T, typename MapFunction, typename ReduceFunction>
+T JobSystem::ParallelReduce(int begin, int end, int grainSize, T const& identity, MapFunction const& map, ReduceFunction const& reduce)
+{
+	// Each participant folds into its own slot, so no two threads ever write the same partial.
+	// Only the slots that can be handed out are copied from identity, T needs no default constructor
+	int numParticipants = GetNumParallelParticipants(begin, end, grainSize);
+	alignas(T) unsigned char partialStorage[MAX_PARALLEL_FOR_PARTICIPANTS * sizeof(T)];
+	T* partials = reinterpret_cast<T*>(partialStorage);
+	for (int i = 0; i < numParticipants; i++)
+	{
+		new (&partials[i]) T(identity);
+	}
+
+	ParallelForParticipants(begin, end, grainSize, [partials, &map, &reduce](int rangeBegin, int rangeEnd, int participantIndex)
+	{
+		T& partial = partials[participantIndex];
+		for (int index = rangeBegin; index < rangeEnd; index++)
+		{
+			partial = reduce(partial, map(index));
+		}
+	});
+
+	T result = identity;
+	for (int i = 0; i < numParticipants; i++)
+	{
+		result = reduce(result, partials[i]);
+		partials[i].~T();
+	}
+	return result;
+}
+
+extern JobSystem* g_theJobSystem;
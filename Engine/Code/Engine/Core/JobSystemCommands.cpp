@@ -0,0 +1,177 @@
+#include "Engine/Core/JobSystemCommands.hpp"
+#include "Engine/Core/JobSystem.hpp"
+#include "Engine/Core/DevConsole.hpp"
+#include "Engine/Core/FileUtils.hpp"
+#include "Engine/Core/StringUtils.hpp"
+
+static char const* GetJobPriorityName(JobPriority priority)
+{
+	switch (priority)
+	{
+	case JobPriority::CRITICAL:		return "CRITICAL";
+	case JobPriority::NORMAL:		return "NORMAL";
+	case JobPriority::BACKGROUND:	return "BACKGROUND";
+	default:						return "UNKNOWN";
+	}
+}
+
+// Upper bound of the bucket that holds the given fraction of the samples, in microseconds
+static unsigned long long GetHistogramPercentileMicroseconds(unsigned int const* histogram, unsigned int numSamples, float fraction)
+{
+	unsigned int target = (unsigned int)((float)numSamples * fraction);
+	unsigned int count = 0;
+	for (int bucket = 0; bucket < NUM_JOB_LATENCY_BUCKETS; bucket++)
+	{
+		count += histogram[bucket];
+		if (count > target)
+		{
+			return 1ull << bucket;
+		}
+	}
+	return 1ull << (NUM_JOB_LATENCY_BUCKETS - 1);
+}
+
+void JobSystemCommandsStartup()
+{
+	g_theEventSystem->SubscribeEventCallbackFunction("JobStats", Command_JobStats);
+	g_theEventSystem->SubscribeEventCallbackFunction("JobTimeline", Command_JobTimeline);
+}
+
+bool WriteJobTimelineToFile(JobSystem const& jobSystem, int numFrames, std::string const& filePath)
+{
+	std::vector<JobTimelineEvent> events;
+	jobSystem.GetTimelineEvents(numFrames - 1, events);
+
+	double originSeconds = jobSystem.GetFrameStartSeconds(numFrames - 1);
+	for (size_t i = 0; i < events.size(); i++)
+	{
+		if (originSeconds == 0.0 || events[i].m_startSeconds < originSeconds)
+		{
+			originSeconds = events[i].m_startSeconds;
+		}
+	}
+
+	std::string json = "{\"traceEvents\":[\n";
+	for (int lane = 0; lane <= jobSystem.GetNumWorkers(); lane++)
+	{
+		std::string laneName = (lane < jobSystem.GetNumWorkers()) ? Stringf("Worker %i", lane) : std::string("Waiting threads");
+		json += Stringf("{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%i,\"args\":{\"name\":\"%s\"}},\n", lane, laneName.c_str());
+	}
+
+	for (int framesAgo = numFrames - 1; framesAgo >= 0; framesAgo--)
+	{
+		double frameStartSeconds = jobSystem.GetFrameStartSeconds(framesAgo);
+		if (frameStartSeconds > 0.0)
+		{
+			json += Stringf("{\"ph\":\"i\",\"s\":\"g\",\"name\":\"Frame -%i\",\"pid\":1,\"tid\":0,\"ts\":%.3f},\n", framesAgo, (frameStartSeconds - originSeconds) * 1000000.0);
+		}
+	}
+
+	for (size_t i = 0; i < events.size(); i++)
+	{
+		JobTimelineEvent const& event = events[i];
+		double queueMicroseconds = (event.m_queuedSeconds > 0.0) ? (event.m_startSeconds - event.m_queuedSeconds) * 1000000.0 : 0.0;
+		json += Stringf("{\"ph\":\"X\",\"name\":\"Type %i\",\"cat\":\"%s\",\"pid\":1,\"tid\":%i,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"queueUs\":%.3f}},\n",
+			event.m_jobType, GetJobPriorityName(event.m_priority), event.m_lane,
+			(event.m_startSeconds - originSeconds) * 1000000.0, (event.m_endSeconds - event.m_startSeconds) * 1000000.0, queueMicroseconds);
+	}
+
+	// The trailing comma of the last entry is not valid JSON, close with an empty metadata record instead
+	json += "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":1,\"args\":{\"name\":\"JobSystem\"}}\n]}\n";
+
+	std::vector<uint8_t> buffer(json.begin(), json.end());
+	return FileWriteFromBuffer(buffer, filePath);
+}
+
+bool Command_JobStats(EventArgs& args)
+{
+	if (!g_theJobSystem)
+	{
+		g_theDevConsole->AddLine(DevConsole::ERROR, "ERROR: There is no job system running");
+		return true;
+	}
+
+	if (args.IsKeyNameValid("enable"))
+	{
+		g_theJobSystem->SetCollectingStats(args.GetValue("enable", true));
+	}
+	if (args.GetValue("reset", false))
+	{
+		g_theJobSystem->ResetStats();
+		g_theDevConsole->AddLine(DevConsole::COMMAND_ECHO, "Job stats reset");
+		return true;
+	}
+
+	g_theDevConsole->AddLine(DevConsole::INFO_MAJOR, g_theJobSystem->IsCollectingStats() ? "JOB STATS (collecting), use JobStats reset=true or enable=false" : "JOB STATS (paused), use JobStats enable=true to start collecting");
+	g_theDevConsole->AddLine(DevConsole::INFO_MINOR, Stringf("Queued: %i critical, %i normal, %i background, %i completed waiting for retrieval",
+		(int)g_theJobSystem->GetNumQueuedJobs(JobPriority::CRITICAL), (int)g_theJobSystem->GetNumQueuedJobs(JobPriority::NORMAL),
+		(int)g_theJobSystem->GetNumQueuedJobs(JobPriority::BACKGROUND), (int)g_theJobSystem->GetNumCompletedJobs()));
+
+	for (int workerIndex = 0; workerIndex < g_theJobSystem->GetNumWorkers(); workerIndex++)
+	{
+		JobWorkerStats stats = g_theJobSystem->GetWorkerStats(workerIndex);
+		double totalSeconds = stats.m_busySeconds + stats.m_stealSeconds + stats.m_idleSeconds;
+		if (totalSeconds <= 0.0)
+		{
+			totalSeconds = 1.0;
+		}
+		g_theDevConsole->AddLine(DevConsole::INFO_MINOR, Stringf("Worker %2i: busy %5.1f%%  steal %5.1f%%  idle %5.1f%%  %u jobs, %u stolen", workerIndex,
+			100.0 * stats.m_busySeconds / totalSeconds, 100.0 * stats.m_stealSeconds / totalSeconds, 100.0 * stats.m_idleSeconds / totalSeconds,
+			stats.m_numJobsExecuted, stats.m_numJobsStolen));
+	}
+
+	for (int jobType = 0; jobType < NUM_JOB_TYPES; jobType++)
+	{
+		JobTypeStats stats = g_theJobSystem->GetJobTypeStats(jobType);
+		if (stats.m_numJobs == 0)
+		{
+			continue;
+		}
+
+		unsigned int numQueueSamples = 0;
+		for (int bucket = 0; bucket < NUM_JOB_LATENCY_BUCKETS; bucket++)
+		{
+			numQueueSamples += stats.m_queueToStartHistogram[bucket];
+		}
+		double averageQueueMicroseconds = (numQueueSamples > 0) ? 1000000.0 * stats.m_totalQueueSeconds / numQueueSamples : 0.0;
+		double averageExecuteMicroseconds = 1000000.0 * stats.m_totalExecuteSeconds / stats.m_numJobs;
+
+		g_theDevConsole->AddLine(DevConsole::INFO_MINOR, Stringf("Type %2i: %u jobs  queue avg %.1fus p50<%lluus p99<%lluus  execute avg %.1fus p50<%lluus p99<%lluus",
+			jobType, stats.m_numJobs,
+			averageQueueMicroseconds, GetHistogramPercentileMicroseconds(stats.m_queueToStartHistogram, numQueueSamples, 0.5f), GetHistogramPercentileMicroseconds(stats.m_queueToStartHistogram, numQueueSamples, 0.99f),
+			averageExecuteMicroseconds, GetHistogramPercentileMicroseconds(stats.m_executeHistogram, stats.m_numJobs, 0.5f), GetHistogramPercentileMicroseconds(stats.m_executeHistogram, stats.m_numJobs, 0.99f)));
+	}
+
+	return true;
+}
+
+bool Command_JobTimeline(EventArgs& args)
+{
+	if (!g_theJobSystem)
+	{
+		g_theDevConsole->AddLine(DevConsole::ERROR, "ERROR: There is no job system running");
+		return true;
+	}
+
+	int numFrames = args.GetValue("frames", 8);
+	std::string filePath = args.GetValue("file", "JobTimeline.json");
+	if (numFrames < 1 || numFrames > JOB_FRAME_HISTORY)
+	{
+		g_theDevConsole->AddLine(DevConsole::ERROR, Stringf("ERROR: frames has to be between 1 and %i, please use JobTimeline frames=<count> file=<path>", JOB_FRAME_HISTORY));
+		return true;
+	}
+
+	if (!g_theJobSystem->IsCollectingStats())
+	{
+		g_theDevConsole->AddLine(DevConsole::WARNING, "Job stats are off, so the timeline only has jobs from before they were paused. Use JobStats enable=true first");
+	}
+	if (WriteJobTimelineToFile(*g_theJobSystem, numFrames, filePath))
+	{
+		g_theDevConsole->AddLine(DevConsole::SUCCESS, Stringf("Wrote the last %i frames of jobs to %s", numFrames, filePath.c_str()));
+	}
+	else
+	{
+		g_theDevConsole->AddLine(DevConsole::ERROR, "ERROR: Could not write " + filePath);
+	}
+	return true;
+}
@@ -0,0 +1,15 @@
+#pragma once
+#include "Engine/Core/EventSystem.hpp"
+#include <string>
+
+class JobSystem;
+
+// DevConsole side of the JobSystem stats, kept apart so JobSystem.cpp builds without the console or the renderer.
+// Call after g_theEventSystem and g_theJobSystem exist
+void JobSystemCommandsStartup();
+
+// Chrome trace (chrome://tracing, Perfetto) of the jobs started in the last numFrames frames
+bool WriteJobTimelineToFile(JobSystem const& jobSystem, int numFrames, std::string const& filePath);
+
+bool Command_JobStats(EventArgs& args);
+bool Command_JobTimeline(EventArgs& args);
@@ -0,0 +1,239 @@
+#include "Engine/Core/JobTask.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+
+// Values of JobTaskPromise::m_continuation other than a waiting coroutine's address
+static void* const TASK_FINISHED = (void*)1;
+static void* const TASK_DETACHED = (void*)2;
+
+std::coroutine_handle<> JobTaskFinalAwaiter::await_suspend(std::coroutine_handle<JobTaskPromise> handle) noexcept
+{
+	// Once TASK_FINISHED is visible the owner may destroy the frame, so only locals are used past this point
+	void* continuation = handle.promise().m_continuation.exchange(TASK_FINISHED);
+	if (continuation == TASK_DETACHED)
+	{
+		handle.destroy();
+		return std::noop_coroutine();
+	}
+	if (continuation)
+	{
+		return std::coroutine_handle<>::from_address(continuation);
+	}
+	return std::noop_coroutine();
+}
+
+JobTask JobTaskPromise::get_return_object()
+{
+	return JobTask(std::coroutine_handle<JobTaskPromise>::from_promise(*this));
+}
+
+void JobTaskPromise::unhandled_exception() const
+{
+	ERROR_AND_DIE("Unhandled exception in a JobTask");
+}
+
+void JobTaskPromise::ResumeOnWorker(std::coroutine_handle<JobTaskPromise> handle)
+{
+	m_system->QueueFunction([handle]() { handle.resume(); }, 1, JobCompletionPolicy::AUTO_RELEASE, m_priority);
+}
+
+JobTask::JobTask(std::coroutine_handle<JobTaskPromise> handle)
+	:m_handle(handle)
+{
+}
+
+JobTask::JobTask(JobTask&& other) noexcept
+	:m_handle(other.m_handle)
+	,m_isStarted(other.m_isStarted)
+{
+	other.m_handle = nullptr;
+	other.m_isStarted = false;
+}
+
+JobTask::~JobTask()
+{
+	Destroy();
+}
+
+JobTask& JobTask::operator=(JobTask&& other) noexcept
+{
+	if (this != &other)
+	{
+		Destroy();
+		m_handle = other.m_handle;
+		m_isStarted = other.m_isStarted;
+		other.m_handle = nullptr;
+		other.m_isStarted = false;
+	}
+	return *this;
+}
+
+void JobTask::Start(JobSystem* system, JobPriority priority)
+{
+	GUARANTEE_OR_DIE(m_handle && !m_isStarted, "JobTask started twice or started empty");
+
+	JobTaskPromise& promise = m_handle.promise();
+	promise.m_system = system;
+	promise.m_priority = priority;
+	m_isStarted = true;
+	promise.ResumeOnWorker(m_handle);
+}
+
+void JobTask::Detach()
+{
+	GUARANTEE_OR_DIE(m_isStarted, "Only a started JobTask can be detached");
+
+	void* expected = nullptr;
+	if (!m_handle.promise().m_continuation.compare_exchange_strong(expected, TASK_DETACHED))
+	{
+		// Already finished, nobody else will free it
+		m_handle.destroy();
+	}
+	m_handle = nullptr;
+	m_isStarted = false;
+}
+
+void JobTask::Wait()
+{
+	GUARANTEE_OR_DIE(m_isStarted, "Waiting on a JobTask that was never started");
+
+	JobSystem* system = m_handle.promise().m_system;
+	while (!IsDone())
+	{
+		if (!system->HelpWithQueuedJob())
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+bool JobTask::IsStarted() const
+{
+	return m_isStarted;
+}
+
+bool JobTask::IsDone() const
+{
+	return m_isStarted && m_handle.promise().m_continuation == TASK_FINISHED;
+}
+
+std::coroutine_handle<> JobTask::await_suspend(std::coroutine_handle<JobTaskPromise> awaitingTask)
+{
+	JobTaskPromise& promise = m_handle.promise();
+	if (!m_isStarted)
+	{
+		// Nothing else can see the task yet, so run it right here and let it hand the thread back when it finishes
+		promise.m_system = awaitingTask.promise().m_system;
+		promise.m_priority = awaitingTask.promise().m_priority;
+		promise.m_continuation = awaitingTask.address();
+		m_isStarted = true;
+		return m_handle;
+	}
+
+	void* expected = nullptr;
+	if (promise.m_continuation.compare_exchange_strong(expected, awaitingTask.address()))
+	{
+		return std::noop_coroutine();
+	}
+
+	// Finished before we got here, carry straight on
+	return awaitingTask;
+}
+
+void JobTask::Destroy()
+{
+	if (!m_handle)
+	{
+		return;
+	}
+
+	GUARANTEE_OR_DIE(!m_isStarted || IsDone(), "JobTask destroyed while still running, Wait or Detach it first");
+	m_handle.destroy();
+	m_handle = nullptr;
+	m_isStarted = false;
+}
+
+void SwitchToWorker::await_suspend(std::coroutine_handle<JobTaskPromise> handle) const
+{
+	if (m_hasPriority)
+	{
+		handle.promise().m_priority = m_priority;
+	}
+	handle.promise().ResumeOnWorker(handle);
+}
+
+bool AwaitJob::await_suspend(std::coroutine_handle<JobTaskPromise> handle) const
+{
+	JobTaskPromise& promise = handle.promise();
+	JobSystem* system = promise.m_system;
+	if (m_job && (m_job->m_state == JobState::COMPLETED || m_job->m_state == JobState::RETRIEVED))
+	{
+		return false;
+	}
+	if (!m_job && !system->GetJob(m_handle))
+	{
+		// Released already, checked again under the job's lock below if this misses
+		return false;
+	}
+
+	// The resume job runs as a continuation of the awaited job, or straight away if that one finishes before the dependency is added
+	JobHandle resumeHandle = system->CreateJob([handle]() { handle.resume(); }, 1, JobCompletionPolicy::AUTO_RELEASE, promise.m_priority);
+	Job* resumeJob = system->GetJob(resumeHandle);
+	if (m_job)
+	{
+		system->AddDependency(resumeJob, m_job);
+	}
+	else if (!system->AddDependencyIfPending(resumeJob, m_handle))
+	{
+		// Already finished, and maybe released with its slot reused; carry straight on
+		system->ReleaseJob(resumeJob);
+		return false;
+	}
+	system->QueueJob(resumeHandle);
+	return true;
+}
+
+bool JobEvent::Awaiter::await_suspend(std::coroutine_handle<JobTaskPromise> handle)
+{
+	m_handle = handle;
+
+	void* state = m_event->m_state.load();
+	do
+	{
+		if (state == m_event)
+		{
+			return false;
+		}
+		m_nextAwaiter = static_cast<Awaiter*>(state);
+	} while (!m_event->m_state.compare_exchange_weak(state, this));
+
+	return true;
+}
+
+void JobEvent::Signal()
+{
+	void* state = m_state.exchange(this);
+	if (state == this)
+	{
+		return;
+	}
+
+	// Each awaiter lives in its task's frame, read the next link before the task can resume and free it
+	Awaiter* awaiter = static_cast<Awaiter*>(state);
+	while (awaiter)
+	{
+		Awaiter* nextAwaiter = awaiter->m_nextAwaiter;
+		awaiter->m_handle.promise().ResumeOnWorker(awaiter->m_handle);
+		awaiter = nextAwaiter;
+	}
+}
+
+void JobEvent::Reset()
+{
+	void* expected = this;
+	m_state.compare_exchange_strong(expected, nullptr);
+}
+
+bool JobEvent::IsSignaled() const
+{
+	return m_state == this;
+}
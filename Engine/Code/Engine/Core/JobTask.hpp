@@ -0,0 +1,214 @@
+#pragma once
+#include "Engine/Core/JobSystem.hpp"
+#include <coroutine>
+
+class JobTask;
+class JobTaskPromise;
+
+// Awaited at the end of every JobTask, hands the thread straight to whoever co_awaited the task
+struct JobTaskFinalAwaiter
+{
+	bool await_ready() const noexcept { return false; }
+	std::coroutine_handle<> await_suspend(std::coroutine_handle<JobTaskPromise> handle) noexcept;
+	void await_resume() const noexcept {}
+};
+
+class JobTaskPromise
+{
+public:
+	JobTask get_return_object();
+	std::suspend_always initial_suspend() const noexcept { return {}; }
+	JobTaskFinalAwaiter final_suspend() const noexcept { return {}; }
+	void return_void() const {}
+	void unhandled_exception() const;
+
+	// Every resumption goes through a pooled job, so a suspended task never holds a thread
+	void ResumeOnWorker(std::coroutine_handle<JobTaskPromise> handle);
+
+public:
+	JobSystem* m_system = nullptr;
+	JobPriority m_priority = JobPriority::NORMAL;
+
+	// Address of the coroutine awaiting this task, or one of the sentinels in JobTask.cpp once it finished or was detached
+	std::atomic<void*> m_continuation = nullptr;
+};
+
+// C++20 coroutine running on JobSystem workers. It starts suspended; Start() queues it, or co_await-ing it from another
+// task runs it inline on the awaiting task's thread. A started task has to finish or be detached before it is destroyed.
+// Results go through the caller's own state, the same way Job subclasses store theirs
+class JobTask
+{
+public:
+	using promise_type = JobTaskPromise;
+
+	JobTask() = default;
+	explicit JobTask(std::coroutine_handle<JobTaskPromise> handle);
+	JobTask(JobTask const& copy) = delete;
+	JobTask(JobTask&& other) noexcept;
+	~JobTask();
+
+	JobTask& operator=(JobTask const& copy) = delete;
+	JobTask& operator=(JobTask&& other) noexcept;
+
+	void Start(JobSystem* system, JobPriority priority = JobPriority::NORMAL);
+	void Detach();	// The task frees itself when it finishes, the JobTask is empty afterwards
+	void Wait();	// Blocks the calling thread, helping with queued jobs in the meantime
+	bool IsStarted() const;
+	bool IsDone() const;
+
+	bool await_ready() const noexcept { return false; }
+	std::coroutine_handle<> await_suspend(std::coroutine_handle<JobTaskPromise> awaitingTask);
+	void await_resume() const noexcept {}
+
+private:
+	void Destroy();
+
+	std::coroutine_handle<JobTaskPromise> m_handle = nullptr;
+	bool m_isStarted = false;
+};
+
+
+// co_await SwitchToWorker() requeues the task, e.g. to let other work in when ShouldYieldToFrame() says so.
+// co_await SwitchToWorker(priority) also moves the rest of the task to that priority
+struct SwitchToWorker
+{
+	SwitchToWorker() = default;
+	explicit SwitchToWorker(JobPriority priority) : m_priority(priority), m_hasPriority(true) {}
+
+	bool await_ready() const noexcept { return false; }
+	void await_suspend(std::coroutine_handle<JobTaskPromise> handle) const;
+	void await_resume() const noexcept {}
+
+	JobPriority m_priority = JobPriority::NORMAL;
+	bool m_hasPriority = false;
+};
+
+// co_await AwaitJob(job) resumes the task once job completes, through the job's continuations.
+// A handle can be awaited at any point, AUTO_RELEASE jobs included. A Job* has to be caller-owned (RETRIEVE or UNTRACKED),
+// the same rule as JobSystem::AddDependency
+struct AwaitJob
+{
+	explicit AwaitJob(Job* job) : m_job(job) {}
+	explicit AwaitJob(JobHandle handle) : m_handle(handle) {}
+
+	bool await_ready() const noexcept { return false; }
+	bool await_suspend(std::coroutine_handle<JobTaskPromise> handle) const;
+	void await_resume() const noexcept {}
+
+	Job* m_job = nullptr;
+	JobHandle m_handle;
+};
+
+// co_await AsyncParallelFor(begin, end, grainSize, function(int index)); unlike JobSystem::ParallelFor the task
+// suspends instead of taking part, and the last participant to finish resumes it
+template <typename Function>
+class AsyncParallelFor
+{
+public:
+	AsyncParallelFor(int begin, int end, int grainSize, Function const& function);
+
+	bool await_ready() const noexcept { return m_range.m_numChunks == 0; }
+	void await_suspend(std::coroutine_handle<JobTaskPromise> handle);
+	void await_resume() const noexcept {}
+
+private:
+	void RunParticipant(int participantIndex);
+
+	ParallelRange m_range;
+	Function m_function;
+	std::coroutine_handle<JobTaskPromise> m_awaitingTask = nullptr;
+	std::atomic<int> m_numActiveParticipants = 0;
+};
+
+// Manual-reset event for I/O and other completions that happen outside the job system.
+// Any number of tasks can co_await it; Signal() may be called from any thread and queues them all back onto workers
+class JobEvent
+{
+	struct Awaiter
+	{
+		bool await_ready() const noexcept { return m_event->IsSignaled(); }
+		bool await_suspend(std::coroutine_handle<JobTaskPromise> handle);
+		void await_resume() const noexcept {}
+
+		JobEvent* m_event = nullptr;
+		std::coroutine_handle<JobTaskPromise> m_handle = nullptr;
+		Awaiter* m_nextAwaiter = nullptr;
+	};
+
+public:
+	JobEvent() = default;
+	JobEvent(JobEvent const& copy) = delete;
+
+	void Signal();
+	void Reset();	// Only once nothing is waiting on it any more
+	bool IsSignaled() const;
+
+	Awaiter operator co_await() { return Awaiter{ this }; }
+
+private:
+	// nullptr when unsignaled with no waiters, this when signaled, otherwise the newest waiting Awaiter
+	std::atomic<void*> m_state = nullptr;
+};
+
+
+template <typename Function>
+AsyncParallelFor<Function>::AsyncParallelFor(int begin, int end, int grainSize, Function const& function)
+	:m_function(function)
+{
+	if (grainSize < 1)
+	{
+		grainSize = 1;
+	}
+
+	m_range.m_begin = begin;
+	m_range.m_end = end;
+	m_range.m_grainSize = grainSize;
+	m_range.m_numChunks = (end > begin) ? (int)(((long long)end - (long long)begin + grainSize - 1) / grainSize) : 0;
+}
+
+template <typename Function>
+void AsyncParallelFor<Function>::await_suspend(std::coroutine_handle<JobTaskPromise> handle)
+{
+	// Once the last participant finishes the task resumes and may free this awaiter, so the loop only uses locals
+	JobSystem* system = handle.promise().m_system;
+	JobPriority priority = handle.promise().m_priority;
+
+	int numJobs = m_range.m_numChunks;
+	if (numJobs > system->GetNumWorkers())
+	{
+		numJobs = system->GetNumWorkers();
+	}
+	if (numJobs > MAX_PARALLEL_FOR_JOBS)
+	{
+		numJobs = MAX_PARALLEL_FOR_JOBS;
+	}
+	if (numJobs < 1)
+	{
+		numJobs = 1;
+	}
+
+	m_awaitingTask = handle;
+	m_numActiveParticipants = numJobs;
+	for (int i = 0; i < numJobs; i++)
+	{
+		system->QueueFunction([this, i]() { RunParticipant(i); }, 1, JobCompletionPolicy::AUTO_RELEASE, priority);
+	}
+}
+
+template <typename Function>
+void AsyncParallelFor<Function>::RunParticipant(int participantIndex)
+{
+	m_range.RunChunks([this](int rangeBegin, int rangeEnd, int)
+	{
+		for (int index = rangeBegin; index < rangeEnd; index++)
+		{
+			m_function(index);
+		}
+	}, participantIndex);
+
+	// The awaiter lives in the task's frame, so nothing may touch it after the task is resumed
+	if (m_numActiveParticipants.fetch_sub(1) == 1)
+	{
+		m_awaitingTask.resume();
+	}
+}
@@ -1,8 +1,13 @@
 #include "Engine/Core/Time.hpp"
+#if defined( _WIN32 )
 #define WIN32_LEAN_AND_MEAN
 #include <Windows.h>
+#else
+#include <chrono>
+#endif
 
 
+#if defined( _WIN32 )
 //-----------------------------------------------------------------------------------------------
 double InitializeTime(LARGE_INTEGER& out_initialTime)
 {
@@ -25,3 +30,13 @@ double GetCurrentTimeSeconds()
 	double currentSeconds = static_cast<double>(elapsedCountsSinceInitialTime) * secondsPerCount;
 	return currentSeconds;
 }
+#else
+//-----------------------------------------------------------------------------------------------
+// Headless builds (tools, benchmarks) off Windows; same contract, seconds since the first call
+double GetCurrentTimeSeconds()
+{
+	static std::chrono::steady_clock::time_point initialTime = std::chrono::steady_clock::now();
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - initialTime;
+	return elapsed.count();
+}
+#endif
@@ -1,6 +1,7 @@
 #include "Engine/Math/AABB3.hpp"
 #include "Engine/Math/MathUtils.hpp"
 #include "Engine/Core/EngineCommon.hpp"
+#include <cfloat>
 
 AABB3::AABB3(AABB3 const& copyfrom)
 	: m_mins(copyfrom.m_mins), m_maxs(copyfrom.m_maxs)
@@ -1,6 +1,7 @@
 #include "Engine/Math/DoubleAABB3.hpp"
 #include "Engine/Math/MathUtils.hpp"
 #include "Engine/Core/EngineCommon.hpp"
+#include <cfloat>
 
 DoubleAABB3::DoubleAABB3(DoubleAABB3 const& copyfrom)
 	: m_mins(copyfrom.m_mins), m_maxs(copyfrom.m_maxs)
@@ -1,6 +1,6 @@
 #include "Engine/Math/MathUtils.hpp"
 #include "Engine/Core/EngineCommon.hpp"
-#include "Engine/Core/RaycastUtils.hpp"
+#include <cfloat>
 
 
 
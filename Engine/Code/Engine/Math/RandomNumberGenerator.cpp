@@ -4,6 +4,7 @@
 #include "ThirdParty/SquirrelNoise/RawNoise.hpp"
 #include <math.h>
 #include <cstdlib> 
+#include <climits>
 #include <time.h> 
 
 int RandomNumberGenerator::RollRandomIntLessThan(int maxNotInclusive)
@@ -57,8 +58,7 @@ bool RandomNumberGenerator::RollRandomChance(float rate)
 
 int RandomNumberGenerator::RollRandomSign()
 {
-	int sign = RollRandomIntInRange(-1, 1);
-	return sign / abs(sign);
+	return (RollRandomIntLessThan(2) == 0) ? -1 : 1;
 }
 
 void RandomNumberGenerator::SetSeed(int seed)
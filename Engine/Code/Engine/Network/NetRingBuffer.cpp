@@ -0,0 +1,147 @@
+#include "Engine/Network/NetRingBuffer.hpp"
+#include <string.h>
+
+void NetRingBuffer::Initialize(int minCapacity)
+{
+	int capacity = 1;
+	while (capacity < minCapacity || capacity < NET_FRAME_HEADER_SIZE + MAX_NET_FRAME_PAYLOAD)
+	{
+		capacity *= 2;
+	}
+	m_bytes.assign(capacity, 0);
+	m_mask = (unsigned int)capacity - 1;
+	Clear();
+}
+
+void NetRingBuffer::Clear()
+{
+	m_readCount = 0;
+	m_writeCount = 0;
+}
+
+int NetRingBuffer::GetCapacity() const
+{
+	return (int)m_bytes.size();
+}
+
+int NetRingBuffer::GetNumBytes() const
+{
+	return (int)(m_writeCount - m_readCount);
+}
+
+int NetRingBuffer::GetNumFreeBytes() const
+{
+	return GetCapacity() - GetNumBytes();
+}
+
+char* NetRingBuffer::GetWriteSpan(int& out_numBytes)
+{
+	unsigned int writeOffset = m_writeCount & m_mask;
+	int numBytesToWrap = GetCapacity() - (int)writeOffset;
+	int numFreeBytes = GetNumFreeBytes();
+	out_numBytes = (numFreeBytes < numBytesToWrap) ? numFreeBytes : numBytesToWrap;
+	return m_bytes.data() + writeOffset;
+}
+
+void NetRingBuffer::CommitWrite(int numBytes)
+{
+	m_writeCount += (unsigned int)numBytes;
+}
+
+char const* NetRingBuffer::GetReadSpan(int& out_numBytes) const
+{
+	unsigned int readOffset = m_readCount & m_mask;
+	int numBytesToWrap = GetCapacity() - (int)readOffset;
+	int numBytes = GetNumBytes();
+	out_numBytes = (numBytes < numBytesToWrap) ? numBytes : numBytesToWrap;
+	return m_bytes.data() + readOffset;
+}
+
+void NetRingBuffer::Consume(int numBytes)
+{
+	m_readCount += (unsigned int)numBytes;
+}
+
+bool NetRingBuffer::Write(void const* data, int numBytes)
+{
+	if (numBytes > GetNumFreeBytes())
+	{
+		return false;
+	}
+
+	CopyIn(0, data, numBytes);
+	m_writeCount += (unsigned int)numBytes;
+	return true;
+}
+
+void NetRingBuffer::CopyIn(int offset, void const* data, int numBytes)
+{
+	unsigned int writeOffset = (m_writeCount + (unsigned int)offset) & m_mask;
+	int numBytesToWrap = GetCapacity() - (int)writeOffset;
+	int numFirstBytes = (numBytes < numBytesToWrap) ? numBytes : numBytesToWrap;
+	memcpy(m_bytes.data() + writeOffset, data, numFirstBytes);
+	memcpy(m_bytes.data(), (char const*)data + numFirstBytes, numBytes - numFirstBytes);
+}
+
+void NetRingBuffer::Peek(int offset, void* out_data, int numBytes) const
+{
+	unsigned int readOffset = (m_readCount + (unsigned int)offset) & m_mask;
+	int numBytesToWrap = GetCapacity() - (int)readOffset;
+	int numFirstBytes = (numBytes < numBytesToWrap) ? numBytes : numBytesToWrap;
+	memcpy(out_data, m_bytes.data() + readOffset, numFirstBytes);
+	memcpy((char*)out_data + numFirstBytes, m_bytes.data(), numBytes - numFirstBytes);
+}
+
+bool NetRingBuffer::WriteFrame(void const* payload, int numBytes)
+{
+	if (numBytes > MAX_NET_FRAME_PAYLOAD || NET_FRAME_HEADER_SIZE + numBytes > GetNumFreeBytes())
+	{
+		return false;
+	}
+
+	// Both parts are copied before the write count moves, so a reader on another thread sees the whole frame at once
+	unsigned char header[NET_FRAME_HEADER_SIZE] = { (unsigned char)(numBytes & 0xff), (unsigned char)(numBytes >> 8) };
+	CopyIn(0, header, NET_FRAME_HEADER_SIZE);
+	CopyIn(NET_FRAME_HEADER_SIZE, payload, numBytes);
+	m_writeCount += (unsigned int)(NET_FRAME_HEADER_SIZE + numBytes);
+	return true;
+}
+
+NetFrameResult NetRingBuffer::PeekFrame(char const*& out_payload, int& out_numBytes, char* scratch) const
+{
+	int numBytes = GetNumBytes();
+	if (numBytes < NET_FRAME_HEADER_SIZE)
+	{
+		return NetFrameResult::NONE;
+	}
+
+	unsigned char header[NET_FRAME_HEADER_SIZE];
+	Peek(0, header, NET_FRAME_HEADER_SIZE);
+	int numPayloadBytes = (int)header[0] | ((int)header[1] << 8);
+	if (numPayloadBytes > MAX_NET_FRAME_PAYLOAD)
+	{
+		return NetFrameResult::INVALID;
+	}
+	if (numBytes < NET_FRAME_HEADER_SIZE + numPayloadBytes)
+	{
+		return NetFrameResult::NONE;
+	}
+
+	unsigned int payloadOffset = (m_readCount + NET_FRAME_HEADER_SIZE) & m_mask;
+	if ((int)payloadOffset + numPayloadBytes <= GetCapacity())
+	{
+		out_payload = m_bytes.data() + payloadOffset;
+	}
+	else
+	{
+		Peek(NET_FRAME_HEADER_SIZE, scratch, numPayloadBytes);
+		out_payload = scratch;
+	}
+	out_numBytes = numPayloadBytes;
+	return NetFrameResult::READY;
+}
+
+void NetRingBuffer::ConsumeFrame(int numPayloadBytes)
+{
+	Consume(NET_FRAME_HEADER_SIZE + numPayloadBytes);
+}
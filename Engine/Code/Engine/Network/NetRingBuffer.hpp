@@ -0,0 +1,52 @@
+#pragma once
+#include <vector>
+#include <atomic>
+
+constexpr int NET_FRAME_HEADER_SIZE = 2;		// Payload length, little-endian
+constexpr int MAX_NET_FRAME_PAYLOAD = 4096;		// Longest payload either end sends or accepts
+
+enum class NetFrameResult
+{
+	NONE,		// No complete frame buffered yet
+	READY,
+	INVALID		// The length is over MAX_NET_FRAME_PAYLOAD, the stream can't be trusted past here
+};
+
+// Fixed byte ring between a socket and the game, allocated once. The capacity is a power of two so offsets wrap with
+// a mask, and the read and write counts only ever grow so a full ring never looks empty. Sockets fill and drain it
+// through the contiguous spans directly, and frames are decoded where they sit.
+// Only the writer moves the write count and only the reader the read count, both atomically after the bytes they
+// cover, so one thread can write while another reads without a lock. Everything else, Clear included, is one thread
+class NetRingBuffer
+{
+public:
+	void Initialize(int minCapacity);	// Rounded up to a power of two and to at least one largest frame
+	void Clear();
+
+	int GetCapacity() const;
+	int GetNumBytes() const;
+	int GetNumFreeBytes() const;
+
+	// The free or buffered bytes up to the wrap, the rest show up on the next call once these are committed
+	char* GetWriteSpan(int& out_numBytes);
+	void CommitWrite(int numBytes);
+	char const* GetReadSpan(int& out_numBytes) const;
+	void Consume(int numBytes);
+
+	bool Write(void const* data, int numBytes);	// All or nothing
+	void Peek(int offset, void* out_data, int numBytes) const;
+
+	bool WriteFrame(void const* payload, int numBytes);	// False, writing nothing, when the frame doesn't fit
+	// The oldest frame's payload. It points into the ring unless the payload wraps, then it is copied to scratch,
+	// which needs MAX_NET_FRAME_PAYLOAD bytes. Valid until ConsumeFrame
+	NetFrameResult PeekFrame(char const*& out_payload, int& out_numBytes, char* scratch) const;
+	void ConsumeFrame(int numPayloadBytes);
+
+private:
+	void CopyIn(int offset, void const* data, int numBytes);	// Past the write count, not yet visible to the reader
+
+	std::vector<char> m_bytes;
+	unsigned int m_mask = 0;
+	std::atomic<unsigned int> m_readCount = 0;
+	std::atomic<unsigned int> m_writeCount = 0;
+};
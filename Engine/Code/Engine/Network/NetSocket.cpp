@@ -0,0 +1,453 @@
+#include "Engine/Network/NetSocket.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#if defined( _WIN32 )
+#define WIN32_LEAN_AND_MEAN
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "Ws2_32.lib")
+#else
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+#include <stdlib.h>
+
+
+#if defined( _WIN32 )
+typedef SOCKET NativeSocket;
+typedef int SocketLength;
+#define NATIVE_INVALID_SOCKET INVALID_SOCKET
+#else
+typedef int NativeSocket;
+typedef socklen_t SocketLength;
+#define NATIVE_INVALID_SOCKET -1
+#endif
+
+// Keeps a dead peer from raising SIGPIPE on POSIX, where a send to a reset connection would otherwise kill the process
+#if defined( MSG_NOSIGNAL )
+constexpr int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+constexpr int SEND_FLAGS = 0;
+#endif
+
+static thread_local int s_lastNetError = 0;
+
+static NativeSocket ToNative(NetSocketHandle handle)
+{
+	return (NativeSocket)(intptr_t)handle;
+}
+
+static NetSocketHandle FromNative(NativeSocket socket)
+{
+	return (socket == NATIVE_INVALID_SOCKET) ? INVALID_NET_SOCKET : (NetSocketHandle)(intptr_t)socket;
+}
+
+static int GetPlatformError()
+{
+#if defined( _WIN32 )
+	return WSAGetLastError();
+#else
+	return errno;
+#endif
+}
+
+// Saves the error for GetLastNetError and sorts it into the results callers act on
+static NetResult GetResultForError(int error)
+{
+	s_lastNetError = error;
+#if defined( _WIN32 )
+	switch (error)
+	{
+	case WSAEWOULDBLOCK:
+	case WSAEINPROGRESS:
+	case WSAEALREADY:
+		return NetResult::WOULD_BLOCK;
+	case WSAECONNRESET:
+	case WSAECONNABORTED:
+	case WSAENOTCONN:
+	case WSAESHUTDOWN:
+		return NetResult::CLOSED;
+	}
+#else
+	if (error == EAGAIN || error == EWOULDBLOCK || error == EINPROGRESS || error == EALREADY || error == EINTR)
+	{
+		return NetResult::WOULD_BLOCK;
+	}
+	if (error == ECONNRESET || error == ECONNABORTED || error == ENOTCONN || error == EPIPE)
+	{
+		return NetResult::CLOSED;
+	}
+#endif
+	return NetResult::FAILED;
+}
+
+static bool SetNonBlocking(NativeSocket socket)
+{
+#if defined( _WIN32 )
+	unsigned long nonBlocking = 1;
+	return ioctlsocket(socket, FIONBIO, &nonBlocking) == 0;
+#else
+	int flags = fcntl(socket, F_GETFL, 0);
+	return flags != -1 && fcntl(socket, F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+}
+
+static void CloseNative(NativeSocket socket)
+{
+#if defined( _WIN32 )
+	closesocket(socket);
+#else
+	close(socket);
+#endif
+}
+
+static sockaddr_in GetSockAddr(NetAddress const& address)
+{
+	sockaddr_in addr = {};
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(address.m_ip);
+	addr.sin_port = htons(address.m_port);
+	return addr;
+}
+
+//-----------------------------------------------------------------------------------------------
+bool NetAddress::FromString(std::string const& addressString, NetAddress& out_address)
+{
+	Strings IPAndPort;
+	SplitStringOnDelimiter(IPAndPort, addressString, ":");
+	if (IPAndPort.size() != 2)
+	{
+		return false;
+	}
+
+	out_address.m_ip = 0;
+	if (!IPAndPort[0].empty())
+	{
+		in_addr addr = {};
+		if (inet_pton(AF_INET, IPAndPort[0].c_str(), &addr) != 1)
+		{
+			return false;
+		}
+		out_address.m_ip = ntohl(addr.s_addr);
+	}
+	out_address.m_port = (unsigned short)atoi(IPAndPort[1].c_str());
+	return true;
+}
+
+std::string NetAddress::ToString() const
+{
+	return Stringf("%u.%u.%u.%u:%u", (m_ip >> 24) & 0xff, (m_ip >> 16) & 0xff, (m_ip >> 8) & 0xff, m_ip & 0xff, (unsigned int)m_port);
+}
+
+//-----------------------------------------------------------------------------------------------
+bool NetStartup()
+{
+#if defined( _WIN32 )
+	WSADATA wsaData;
+	int result = WSAStartup(MAKEWORD(2, 2), &wsaData);
+	if (result != 0)
+	{
+		s_lastNetError = result;
+		return false;
+	}
+#endif
+	return true;
+}
+
+void NetShutdown()
+{
+#if defined( _WIN32 )
+	WSACleanup();
+#endif
+}
+
+int GetLastNetError()
+{
+	return s_lastNetError;
+}
+
+//-----------------------------------------------------------------------------------------------
+bool NetSocket::OpenTcp()
+{
+	Close();
+
+	NativeSocket socketHandle = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (socketHandle == NATIVE_INVALID_SOCKET)
+	{
+		GetResultForError(GetPlatformError());
+		return false;
+	}
+	if (!SetNonBlocking(socketHandle))
+	{
+		GetResultForError(GetPlatformError());
+		CloseNative(socketHandle);
+		return false;
+	}
+#if defined( SO_NOSIGPIPE )
+	int noSigPipe = 1;
+	setsockopt(socketHandle, SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe, sizeof(noSigPipe));
+#endif
+
+	m_handle = FromNative(socketHandle);
+	return true;
+}
+
+void NetSocket::Close()
+{
+	if (m_handle != INVALID_NET_SOCKET)
+	{
+		CloseNative(ToNative(m_handle));
+		m_handle = INVALID_NET_SOCKET;
+	}
+	m_isConnecting = false;
+}
+
+bool NetSocket::IsOpen() const
+{
+	return m_handle != INVALID_NET_SOCKET;
+}
+
+NetSocketHandle NetSocket::GetHandle() const
+{
+	return m_handle;
+}
+
+bool NetSocket::Listen(NetAddress const& address)
+{
+	NativeSocket socketHandle = ToNative(m_handle);
+
+	// Lets a restarted server bind again while the last run's connections sit in TIME_WAIT. Windows lets any
+	// process steal the port with this option, and doesn't need it to rebind, so it is left off there
+#if !defined( _WIN32 )
+	int reuseAddress = 1;
+	setsockopt(socketHandle, SOL_SOCKET, SO_REUSEADDR, &reuseAddress, sizeof(reuseAddress));
+#endif
+
+	sockaddr_in addr = GetSockAddr(address);
+	if (bind(socketHandle, (sockaddr*)&addr, (SocketLength)sizeof(addr)) != 0 || listen(socketHandle, SOMAXCONN) != 0)
+	{
+		GetResultForError(GetPlatformError());
+		return false;
+	}
+	return true;
+}
+
+NetResult NetSocket::Accept(NetSocket& out_socket)
+{
+	NativeSocket acceptedSocket = accept(ToNative(m_handle), nullptr, nullptr);
+	if (acceptedSocket == NATIVE_INVALID_SOCKET)
+	{
+		NetResult result = GetResultForError(GetPlatformError());
+		return (result == NetResult::CLOSED) ? NetResult::WOULD_BLOCK : result;	// A client that gave up while queued
+	}
+	if (!SetNonBlocking(acceptedSocket))
+	{
+		GetResultForError(GetPlatformError());
+		CloseNative(acceptedSocket);
+		return NetResult::FAILED;
+	}
+#if defined( SO_NOSIGPIPE )
+	int noSigPipe = 1;
+	setsockopt(acceptedSocket, SOL_SOCKET, SO_NOSIGPIPE, &noSigPipe, sizeof(noSigPipe));
+#endif
+
+	out_socket.Close();
+	out_socket.m_handle = FromNative(acceptedSocket);
+	return NetResult::DONE;
+}
+
+NetResult NetSocket::Connect(NetAddress const& address)
+{
+	NativeSocket socketHandle = ToNative(m_handle);
+	if (!m_isConnecting)
+	{
+		sockaddr_in addr = GetSockAddr(address);
+		if (connect(socketHandle, (sockaddr*)&addr, (SocketLength)sizeof(addr)) == 0)
+		{
+			return NetResult::DONE;
+		}
+		if (GetResultForError(GetPlatformError()) != NetResult::WOULD_BLOCK)
+		{
+			return NetResult::FAILED;
+		}
+		m_isConnecting = true;
+	}
+
+	// Still connecting until the socket turns writable; a refused or unreachable host shows up as a socket error
+#if defined( _WIN32 )
+	fd_set writeSockets;
+	fd_set exceptSockets;
+	FD_ZERO(&writeSockets);
+	FD_ZERO(&exceptSockets);
+	FD_SET(socketHandle, &writeSockets);
+	FD_SET(socketHandle, &exceptSockets);
+	timeval waitTime = {};
+	int numReady = select(0, nullptr, &writeSockets, &exceptSockets, &waitTime);
+	bool isFinished = numReady > 0 && (FD_ISSET(socketHandle, &writeSockets) || FD_ISSET(socketHandle, &exceptSockets));
+#else
+	pollfd pollSocket = {};
+	pollSocket.fd = socketHandle;
+	pollSocket.events = POLLOUT;
+	int numReady = poll(&pollSocket, 1, 0);
+	bool isFinished = numReady > 0 && (pollSocket.revents & (POLLOUT | POLLERR | POLLHUP)) != 0;
+#endif
+	if (numReady < 0)
+	{
+		m_isConnecting = false;
+		GetResultForError(GetPlatformError());
+		return NetResult::FAILED;
+	}
+	if (!isFinished)
+	{
+		return NetResult::WOULD_BLOCK;
+	}
+
+	m_isConnecting = false;
+	int socketError = 0;
+	SocketLength errorLength = (SocketLength)sizeof(socketError);
+	getsockopt(socketHandle, SOL_SOCKET, SO_ERROR, (char*)&socketError, &errorLength);
+	if (socketError != 0)
+	{
+		GetResultForError(socketError);
+		return NetResult::FAILED;
+	}
+	return NetResult::DONE;
+}
+
+NetResult NetSocket::Send(void const* data, int numBytes, int& out_numBytesSent)
+{
+	out_numBytesSent = 0;
+	int result = (int)send(ToNative(m_handle), (char const*)data, numBytes, SEND_FLAGS);
+	if (result < 0)
+	{
+		return GetResultForError(GetPlatformError());
+	}
+	out_numBytesSent = result;
+	return (result > 0 || numBytes == 0) ? NetResult::DONE : NetResult::WOULD_BLOCK;
+}
+
+NetResult NetSocket::Receive(void* out_data, int maxBytes, int& out_numBytesReceived)
+{
+	out_numBytesReceived = 0;
+	int result = (int)recv(ToNative(m_handle), (char*)out_data, maxBytes, 0);
+	if (result < 0)
+	{
+		return GetResultForError(GetPlatformError());
+	}
+	if (result == 0)
+	{
+		return NetResult::CLOSED;
+	}
+	out_numBytesReceived = result;
+	return NetResult::DONE;
+}
+
+//-----------------------------------------------------------------------------------------------
+bool NetWakeSocket::Open()
+{
+	Close();
+
+	NativeSocket socketHandle = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+	if (socketHandle == NATIVE_INVALID_SOCKET)
+	{
+		GetResultForError(GetPlatformError());
+		return false;
+	}
+
+	// Bound to a port the OS picks, then connected to that same port so Wake's byte comes straight back
+	NetAddress loopback;
+	loopback.m_ip = 0x7f000001;
+	sockaddr_in addr = GetSockAddr(loopback);
+	SocketLength addrLength = (SocketLength)sizeof(addr);
+	if (bind(socketHandle, (sockaddr*)&addr, addrLength) != 0 || getsockname(socketHandle, (sockaddr*)&addr, &addrLength) != 0 ||
+		connect(socketHandle, (sockaddr*)&addr, addrLength) != 0 || !SetNonBlocking(socketHandle))
+	{
+		GetResultForError(GetPlatformError());
+		CloseNative(socketHandle);
+		return false;
+	}
+
+	m_handle = FromNative(socketHandle);
+	return true;
+}
+
+void NetWakeSocket::Close()
+{
+	if (m_handle != INVALID_NET_SOCKET)
+	{
+		CloseNative(ToNative(m_handle));
+		m_handle = INVALID_NET_SOCKET;
+	}
+}
+
+bool NetWakeSocket::IsOpen() const
+{
+	return m_handle != INVALID_NET_SOCKET;
+}
+
+NetSocketHandle NetWakeSocket::GetHandle() const
+{
+	return m_handle;
+}
+
+void NetWakeSocket::Wake()
+{
+	// A full socket buffer already reads as woken, so a failed send needs nothing more
+	char wakeByte = 0;
+	send(ToNative(m_handle), &wakeByte, 1, SEND_FLAGS);
+}
+
+void NetWakeSocket::Drain()
+{
+	char wakeBytes[64];
+	while (recv(ToNative(m_handle), wakeBytes, (int)sizeof(wakeBytes), 0) > 0)
+	{
+	}
+}
+
+bool WaitForNetSockets(NetSocketHandle socket, bool waitForRead, bool waitForWrite, NetWakeSocket const& wakeSocket, int timeoutMilliseconds)
+{
+	NativeSocket wakeHandle = ToNative(wakeSocket.GetHandle());
+	NativeSocket socketHandle = ToNative(socket);
+	bool hasSocket = socket != INVALID_NET_SOCKET && (waitForRead || waitForWrite);
+
+#if defined( _WIN32 )
+	// A refused connect only shows up in the except set, as in NetSocket::Connect
+	fd_set readSockets;
+	fd_set writeSockets;
+	fd_set exceptSockets;
+	FD_ZERO(&readSockets);
+	FD_ZERO(&writeSockets);
+	FD_ZERO(&exceptSockets);
+	FD_SET(wakeHandle, &readSockets);
+	if (hasSocket && waitForRead)
+	{
+		FD_SET(socketHandle, &readSockets);
+	}
+	if (hasSocket && waitForWrite)
+	{
+		FD_SET(socketHandle, &writeSockets);
+		FD_SET(socketHandle, &exceptSockets);
+	}
+	timeval waitTime = {};
+	waitTime.tv_sec = timeoutMilliseconds / 1000;
+	waitTime.tv_usec = (timeoutMilliseconds % 1000) * 1000;
+	int numReady = select(0, &readSockets, &writeSockets, &exceptSockets, &waitTime);
+#else
+	pollfd pollSockets[2] = {};
+	pollSockets[0].fd = wakeHandle;
+	pollSockets[0].events = POLLIN;
+	pollSockets[1].fd = socketHandle;
+	pollSockets[1].events = (short)((waitForRead ? POLLIN : 0) | (waitForWrite ? POLLOUT : 0));
+	int numReady = poll(pollSockets, hasSocket ? 2 : 1, timeoutMilliseconds);
+#endif
+	if (numReady < 0)
+	{
+		return GetResultForError(GetPlatformError()) == NetResult::WOULD_BLOCK;	// Interrupted, as good as a timeout
+	}
+	return true;
+}
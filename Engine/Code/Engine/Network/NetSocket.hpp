@@ -0,0 +1,77 @@
+#pragma once
+#include <stdint.h>
+#include <string>
+
+// TCP sockets behind one small API, Winsock on Windows and BSD sockets everywhere else, so nothing above this
+// includes a platform header. Sockets are non-blocking from the moment they open; on POSIX the handle is a plain
+// file descriptor and can go straight into poll or epoll
+
+typedef uintptr_t NetSocketHandle;
+constexpr NetSocketHandle INVALID_NET_SOCKET = ~(NetSocketHandle)0;	// INVALID_SOCKET on Windows, -1 elsewhere
+
+enum class NetResult
+{
+	DONE,			// Connected, accepted, or some bytes moved
+	WOULD_BLOCK,	// Nothing to do yet, try again on a later poll
+	CLOSED,			// The peer closed or reset the connection
+	FAILED			// Anything else, GetLastNetError has the platform code
+};
+
+struct NetAddress
+{
+	unsigned int m_ip = 0;		// Host byte order, 0 for any address
+	unsigned short m_port = 0;
+
+	// "127.0.0.1:3100", or ":3100" to listen on every address
+	static bool FromString(std::string const& addressString, NetAddress& out_address);
+	std::string ToString() const;
+};
+
+bool NetStartup();	// Once per process before any socket opens
+void NetShutdown();
+int GetLastNetError();	// WSAGetLastError or errno from the most recent call that FAILED
+
+class NetSocket
+{
+public:
+	bool OpenTcp();
+	void Close();
+	bool IsOpen() const;
+	NetSocketHandle GetHandle() const;
+
+	bool Listen(NetAddress const& address);
+	NetResult Accept(NetSocket& out_socket);
+
+	// Starts connecting on the first call; call again each poll until it stops returning WOULD_BLOCK. After FAILED
+	// the socket has to be closed and opened again before the next attempt
+	NetResult Connect(NetAddress const& address);
+
+	NetResult Send(void const* data, int numBytes, int& out_numBytesSent);
+	NetResult Receive(void* out_data, int maxBytes, int& out_numBytesReceived);
+
+private:
+	NetSocketHandle m_handle = INVALID_NET_SOCKET;
+	bool m_isConnecting = false;
+};
+
+// A loopback UDP socket connected to itself. Any thread can Wake it, which makes it readable, so a thread blocked in
+// WaitForNetSockets returns straight away instead of waiting out its timeout
+class NetWakeSocket
+{
+public:
+	bool Open();
+	void Close();
+	bool IsOpen() const;
+	NetSocketHandle GetHandle() const;
+
+	void Wake();	// Any thread
+	void Drain();	// The waiting thread, before it looks for whatever it was woken for
+
+private:
+	NetSocketHandle m_handle = INVALID_NET_SOCKET;
+};
+
+// Blocks until socket can read or write, whichever is asked for, wakeSocket is woken, or timeoutMilliseconds pass.
+// socket can be INVALID_NET_SOCKET to wait on the wake socket alone. select on Windows, poll elsewhere, so unlike a
+// sleep the wait ends as soon as there is work. False when the wait itself failed
+bool WaitForNetSockets(NetSocketHandle socket, bool waitForRead, bool waitForWrite, NetWakeSocket const& wakeSocket, int timeoutMilliseconds);
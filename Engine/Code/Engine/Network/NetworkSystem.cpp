@@ -1,14 +1,19 @@
 #include "Engine/Network/NetworkSystem.hpp"
 #include "Engine/Core/ErrorWarningAssert.hpp"
 #include "Engine/Core/DevConsole.hpp"
+#include "Engine/Core/Time.hpp"
+#include <chrono>
 
 NetWorkSystem* g_theNetwork = nullptr;
 
+// Longest the I/O thread blocks waiting on its socket. Socket activity and frames the game queues end the wait early,
+// so this only paces connect retries and a game that has fallen behind on the inbound queue
+constexpr int NET_IO_WAIT_MILLISECONDS = 10;
+
 NetWorkSystem::NetWorkSystem(NetworkConfig config)
 	:m_config(config)
 {
 	m_mode = NetMode::NONE;
-	m_clientSocket = INVALID_SOCKET;
 }
 
 NetWorkSystem::~NetWorkSystem()
@@ -23,10 +28,22 @@ void NetWorkSystem::Startup()
 #endif
 	if (!IsEnable()) return;
 
-	InitializeWinsock();
+	if (!NetStartup())
+	{
+		ERROR_AND_DIE(Stringf("Failed to initialize sockets: %d", GetLastNetError()));
+	}
 
-	m_sendBuffer = new char[m_config.m_sendBufferSize];
-	m_recvBuffer = new char[m_config.m_recvBufferSize];
+	m_sendRing.Initialize(m_config.m_sendBufferSize);
+	m_recvRing.Initialize(m_config.m_recvBufferSize);
+	m_outboundQueue.Initialize(m_config.m_sendBufferSize);
+	m_inboundQueue.Initialize(m_config.m_recvBufferSize);
+	m_frameScratch = new char[MAX_NET_FRAME_PAYLOAD];
+	m_inboundScratch = new char[MAX_NET_FRAME_PAYLOAD];
+	ResetConnectionBuffers();
+	if (!m_wakeSocket.Open())
+	{
+		ERROR_AND_DIE(Stringf("Failed to create the network wake socket, error code: %d", GetLastNetError()));
+	}
 
 	if (ToLower(m_config.m_modeString) == "client") 
 	{
@@ -50,6 +67,12 @@ void NetWorkSystem::Startup()
 		CreateAndBindServerSocket();;
 	}
 
+	// The sockets belong to the I/O thread from here on
+	if (m_mode != NetMode::NONE)
+	{
+		m_ioThread = new std::thread(&NetWorkSystem::IOThreadMain, this);
+	}
+
 	SubscribeEventCallbackFunction("BurstTest", NetWorkSystem::BurstTest);
 	SubscribeEventCallbackFunction("RemoteCommand", NetWorkSystem::RemoteCommand);
 }
@@ -61,22 +84,24 @@ void NetWorkSystem::Shutdown()
 #endif
 	if (!IsEnable()) return;
 
-	if (m_clientSocket != INVALID_SOCKET)
-	{
-		closesocket(m_clientSocket);
-		m_clientSocket = INVALID_SOCKET;
-	}
-	if (m_listenSocket != INVALID_SOCKET)
+	if (m_ioThread)
 	{
-		closesocket(m_listenSocket);
-		m_listenSocket = INVALID_SOCKET;
+		m_isShuttingDown = true;
+		m_wakeSocket.Wake();
+		m_ioThread->join();
+		delete m_ioThread;
+		m_ioThread = nullptr;
 	}
-	WSACleanup();
 
-	delete[] m_sendBuffer;
-	delete[] m_recvBuffer;
-	m_sendBuffer = nullptr;
-	m_recvBuffer = nullptr;
+	m_clientSocket.Close();
+	m_listenSocket.Close();
+	m_wakeSocket.Close();
+	NetShutdown();
+
+	delete[] m_frameScratch;
+	m_frameScratch = nullptr;
+	delete[] m_inboundScratch;
+	m_inboundScratch = nullptr;
 }
 
 void NetWorkSystem::BeginFrame()
@@ -84,117 +109,31 @@ void NetWorkSystem::BeginFrame()
 #if defined(ENGINE_DISABLE_NETWORK)
 	return;
 #endif
-	if (!IsEnable()) return;
-                                                                                                                            
-	if (m_mode == NetMode::CLIENT) {
-		// Check if our connection attempt has completed.
-		sockaddr_in addr;
-		addr.sin_family = AF_INET;
-		addr.sin_addr.S_un.S_addr = htonl(m_hostAddress);
-		addr.sin_port = htons(m_hostPort);
-		int result = connect(m_clientSocket, (sockaddr*)(&addr), (int)sizeof(addr));
-
-		fd_set writeSockets;
-		fd_set exceptSockets;
-		FD_ZERO(&writeSockets);
-		FD_ZERO(&exceptSockets);
-		FD_SET(m_clientSocket, &writeSockets);
-		FD_SET(m_clientSocket, &exceptSockets);
-		timeval waitTime = { };
-		result = select(0, NULL, &writeSockets, &exceptSockets, &waitTime);
-
-		// We are connected if the following is true.
-		if (result >= 0) 
-		{
-			if (FD_ISSET(m_clientSocket, &writeSockets)) 
-			{
-				// Send and receive if we are connected.
-				m_clientState = ClientState::Connected;
-				if (!ProcessMessage()) {
-					goto PrintState;
-				}
-			}
-			else if (FD_ISSET(m_clientSocket, &exceptSockets)) 
-			{
-				// Attempt to connect if we haven't already.
-				addr.sin_family = AF_INET;
-				addr.sin_addr.S_un.S_addr = htonl(m_hostAddress);
-				addr.sin_port = htons(m_hostPort);
-				result = connect(m_clientSocket, (sockaddr*)(&addr), (int)sizeof(addr));
-				if (result <= 0) 
-				{
-					int error = WSAGetLastError();
-					if (error == WSAEWOULDBLOCK || error == WSAEALREADY) 
-					{
-						goto PrintState;
-					}
-				}
-
-				// Check if our connection attempt failed.
-				FD_ZERO(&exceptSockets);
-				FD_SET(m_clientSocket, &exceptSockets);
-				waitTime = { };
-				result = select(0, NULL, &writeSockets, &exceptSockets, &waitTime);
+	if (!IsEnable() || m_mode == NetMode::NONE) return;
 
-				// The connection failed if the following is true, in which case we need to connect again.
-				if (result > 0 && FD_ISSET(m_clientSocket, &exceptSockets) && FD_ISSET(m_clientSocket, &writeSockets)) 
-				{
-					m_clientState = ClientState::Connected;
-				}
-			}
-			else 
-			{
-				if (HandleErrors()) 
-				{
-					goto PrintState;
-				}
-			}
-		}
-		else if (result < 0) 
-		{
-			if (HandleErrors()) 
-			{
-				goto PrintState;
-			}
-		}
-
-	PrintState:
-		if (m_lastFrameClientState == ClientState::Disconnected && m_clientState == ClientState::Connected) 
-		{
-			g_theDevConsole->AddLine(Rgba8(255, 255, 255), Stringf("Connected to Server %s! Socket: %lld", 
-				m_config.m_hostAddressString.c_str(), m_clientSocket));
-		}
-		else if (m_lastFrameClientState == ClientState::Connected && m_clientState == ClientState::Disconnected) 
-		{
-			g_theDevConsole->AddLine(Rgba8(255, 255, 255), Stringf("Disconnected from Server %s! Socket: %lld", 
-				m_config.m_hostAddressString.c_str(), m_clientSocket));
-		}
-		m_lastFrameClientState = m_clientState;
+	// Everything the I/O thread decoded since last frame, in the order it arrived
+	char const* payload = nullptr;
+	int numBytes = 0;
+	while (m_inboundQueue.PeekFrame(payload, numBytes, m_inboundScratch) == NetFrameResult::READY)
+	{
+		ExecuteRecvMessage(payload, numBytes);
+		m_inboundQueue.ConsumeFrame(numBytes);
 	}
-	else if (m_mode == NetMode::SERVER) 
+
+	if (!m_sendOverflow.empty())
 	{
-		// If we do not have a connection, check for connections to accept.
-		if (m_clientSocket == INVALID_SOCKET) 
+		while (!m_sendOverflow.empty() && m_outboundQueue.WriteFrame(m_sendOverflow.front().data(), (int)m_sendOverflow.front().size()))
 		{
-			m_clientSocket = accept(m_listenSocket, NULL, NULL);
-			if (m_clientSocket != INVALID_SOCKET) 
-			{
-				// If a connection is accepted set blocking mode.
-				unsigned long blockingMode = 1;
-				ioctlsocket(m_clientSocket, FIONBIO, &blockingMode);
-				g_theDevConsole->AddLine(Rgba8(255, 255, 255), Stringf("Connected to Client! Socket: %lld", m_clientSocket));
-			}
+			m_sendOverflow.pop_front();
 		}
-		else {
-		
-			if (!ProcessMessage()) 
-			{
-				return;
-			}
-		}
-
+		WakeIOThread();
 	}
 
+	double stateSendInterval = (m_config.m_stateSendRate > 0.f) ? 1.0 / (double)m_config.m_stateSendRate : 0.0;
+	if (GetCurrentTimeSeconds() - m_lastStateSendSeconds >= stateSendInterval)
+	{
+		FlushStateChannels();
+	}
 }
 
 void NetWorkSystem::EndFrame()
@@ -225,213 +164,438 @@ bool NetWorkSystem::IsConnected() const
 	return m_clientState == ClientState::Connected;
 }
 
-void NetWorkSystem::Send(std::string data)
+void NetWorkSystem::SetMessageCallback(NetMessageCallbackFunction callback)
 {
-	m_sendQueue.push_back(data);
+	m_messageCallback = callback;
 }
 
-bool NetWorkSystem::RemoteCommand(EventArgs& args)
+void NetWorkSystem::Send(void const* payload, int numBytes)
 {
-	std::string line = args.GetValue("command", "");
-	Strings totalCommands = SplitStringWithQuotes(line, ' ');
-	for (auto & cmd : totalCommands)
+	if (!IsEnable() || m_mode == NetMode::NONE)
 	{
-		TrimString(cmd,'\"');
-		ToLower(cmd);
-		g_theNetwork->Send(Stringf(cmd.c_str()));
+		return;
+	}
+	if (numBytes > MAX_NET_FRAME_PAYLOAD)
+	{
+		g_theDevConsole->AddLine(DevConsole::ERROR, Stringf("Dropped a %d byte message, the most a frame holds is %d", numBytes, MAX_NET_FRAME_PAYLOAD));
+		return;
 	}
 
-	return true;
+	// Pending state goes out first, so the peer never sees an action ahead of the state it was taken in
+	FlushStateChannels();
+	QueueFrame(payload, numBytes);
 }
 
-bool NetWorkSystem::BurstTest(EventArgs& args)
+void NetWorkSystem::SendLatest(void const* payload, int numBytes)
 {
-	for (size_t i = 0; i < 20; i++)
+	if (!IsEnable() || m_mode == NetMode::NONE || numBytes < 1)
 	{
-		args.SetValue("command", Stringf("\"echo message=%i\"", i));
-		g_theNetwork->RemoteCommand(args);
+		return;
 	}
-	return true;
+	if (numBytes > MAX_NET_FRAME_PAYLOAD)
+	{
+		g_theDevConsole->AddLine(DevConsole::ERROR, Stringf("Dropped a %d byte message, the most a frame holds is %d", numBytes, MAX_NET_FRAME_PAYLOAD));
+		return;
+	}
+
+	unsigned char type = *(unsigned char const*)payload;
+	for (NetStateChannel& channel : m_stateChannels)
+	{
+		if (channel.m_type == type)
+		{
+			channel.m_latest.assign((char const*)payload, numBytes);
+			return;
+		}
+	}
+
+	NetStateChannel channel;
+	channel.m_type = type;
+	channel.m_latest.assign((char const*)payload, numBytes);
+	m_stateChannels.push_back(channel);
 }
 
-void NetWorkSystem::ExecuteRecvMessage(std::string const& message)
+void NetWorkSystem::QueueFrame(void const* payload, int numBytes)
 {
-	g_theDevConsole->Execute(message, true);
+	// Messages go straight to the I/O thread; only a burst bigger than the queue waits, in order, in the overflow
+	if (m_sendOverflow.empty() && m_outboundQueue.WriteFrame(payload, numBytes))
+	{
+		WakeIOThread();
+		return;
+	}
+	m_sendOverflow.push_back(std::string((char const*)payload, numBytes));
 }
 
-void NetWorkSystem::InitializeWinsock()
+// One wake per wait is enough, more would only pile up in the wake socket. The I/O thread clears m_isWakePending
+// before it drains m_outboundQueue, so a frame written after that always gets a wake of its own
+void NetWorkSystem::WakeIOThread()
 {
-	WSADATA wsaData;
-	int result = WSAStartup(MAKEWORD(2, 2), &wsaData);
-	if (result != 0)
+	if (!m_isWakePending.exchange(true))
 	{
-		ERROR_AND_DIE("Failed to initialize Winsock");
+		m_wakeSocket.Wake();
 	}
 }
 
-void NetWorkSystem::CreateAndBindServerSocket()
+// Only what changed since it last went out, however many times it was set in between
+void NetWorkSystem::FlushStateChannels()
 {
-	// Create listen socket.
-	m_listenSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
-	if (m_listenSocket == INVALID_SOCKET)
+	for (NetStateChannel& channel : m_stateChannels)
 	{
-		WSACleanup();
-		ERROR_AND_DIE(Stringf("Error at socket(): %ld\n", WSAGetLastError()));
+		if (channel.m_latest != channel.m_lastSent)
+		{
+			QueueFrame(channel.m_latest.data(), (int)channel.m_latest.size());
+			channel.m_lastSent = channel.m_latest;
+		}
 	}
+	m_lastStateSendSeconds = GetCurrentTimeSeconds();
+}
 
-	// Set blocking mode.
-	unsigned long blockingMode = 1;
-	int result = ioctlsocket(m_listenSocket, FIONBIO, &blockingMode);
-
-	// Get host port from string.
-	Strings IPAndPort;
-	SplitStringOnDelimiter(IPAndPort, m_config.m_hostAddressString, ":");
-	m_hostAddress = INADDR_ANY;
-	m_hostPort = (unsigned short)(atoi(IPAndPort[1].c_str()));
+void NetWorkSystem::SendConsoleCommand(std::string const& command)
+{
+	std::string payload(1, (char)NET_MESSAGE_CONSOLE);
+	payload.append(command);
+	Send(payload.data(), (int)payload.size());
+}
 
-	// Bind the listen socket to a port.
-	sockaddr_in addr = { };
-	addr.sin_family = AF_INET;
-	addr.sin_addr.S_un.S_addr = htonl(m_hostAddress);
-	addr.sin_port = htons(m_hostPort);
-	result = bind(m_listenSocket, (sockaddr*)&addr, (int)sizeof(addr));
-	if (result == SOCKET_ERROR) 
+bool NetWorkSystem::RemoteCommand(EventArgs& args)
+{
+	std::string line = args.GetValue("command", "");
+	Strings totalCommands = SplitStringWithQuotes(line, ' ');
+	for (auto & cmd : totalCommands)
 	{
-		WSACleanup();
-		ERROR_AND_DIE(Stringf("bind failed with error: %d\n", WSAGetLastError()));
+		TrimString(cmd,'\"');
+		ToLower(cmd);
+		g_theNetwork->SendConsoleCommand(cmd);
 	}
 
-	// Listen for connections to accept.
-	result = listen(m_listenSocket, SOMAXCONN);
+	return true;
 }
 
-void NetWorkSystem::CreateClientSocket()
+bool NetWorkSystem::BurstTest(EventArgs& args)
 {
-	m_clientSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
-	if (m_clientSocket == INVALID_SOCKET) 
+	for (size_t i = 0; i < 20; i++)
 	{
-		WSACleanup();
-		ERROR_AND_DIE(Stringf("Error at socket(): %ld\n", WSAGetLastError()));
+		args.SetValue("command", Stringf("\"echo message=%i\"", i));
+		g_theNetwork->RemoteCommand(args);
 	}
-
-	// Set blocking mode
-	unsigned long blockingMode = 1;
-	int result = ioctlsocket(m_clientSocket, FIONBIO, &blockingMode);
-
-	// Get host address from string.
-	Strings IPAndPort;
-	SplitStringOnDelimiter(IPAndPort, m_config.m_hostAddressString, ":");
-	IN_ADDR addr = { };
-	result = inet_pton(AF_INET, IPAndPort[0].c_str(), &addr);
-
-	m_hostAddress = ntohl(addr.S_un.S_addr);
-
-	// Get host port from string
-	m_hostPort = (unsigned short)(atoi(IPAndPort[1].c_str()));
+	return true;
 }
-bool NetWorkSystem::HandleErrors()
+
+void NetWorkSystem::ExecuteRecvMessage(char const* payload, int numBytes)
 {
-	int error = WSAGetLastError();
-	if (error == WSAECONNABORTED || error == WSAECONNRESET || error == 0) 
+	if (numBytes < 1)
 	{
-		if (m_mode == NetMode::SERVER) 
-		{
-			m_clientSocket = INVALID_SOCKET;
-		}
-		else if (m_mode == NetMode::CLIENT)
+		return;
+	}
+
+	unsigned char type = (unsigned char)payload[0];
+	if (type == NET_MESSAGE_HELLO)
+	{
+		m_peerProtocolVersion = (numBytes > 1) ? (int)(unsigned char)payload[1] : -1;
+		if (m_peerProtocolVersion != (int)m_config.m_protocolVersion)
 		{
-			m_clientState = ClientState::Disconnected;
-			CreateClientSocket();
+			g_theDevConsole->AddLine(DevConsole::ERROR, Stringf("Peer speaks protocol %d, this build speaks %d; only console commands will get through",
+				m_peerProtocolVersion, (int)m_config.m_protocolVersion));
 		}
 	}
-	else if (error == WSAEWOULDBLOCK || error == WSAEALREADY) 
+	else if (type == NET_MESSAGE_CONSOLE)
 	{
-		return true;
+		g_theDevConsole->Execute(std::string(payload + 1, numBytes - 1), true);
 	}
-	else 
+	else if (type == NET_NOTICE_CONNECTED || type == NET_NOTICE_DISCONNECTED)
 	{
-		g_theDevConsole->AddLine(DevConsole::ERROR, Stringf("Error code: %d", error));
+		ResetConnectionState();
+		g_theDevConsole->AddLine(Rgba8(255, 255, 255), std::string(payload + 1, numBytes - 1));
+	}
+	else if (type == NET_NOTICE_ERROR)
+	{
+		g_theDevConsole->AddLine(DevConsole::ERROR, std::string(payload + 1, numBytes - 1));
+	}
+	else if (type >= FIRST_GAME_NET_MESSAGE && m_messageCallback && m_peerProtocolVersion == (int)m_config.m_protocolVersion)
+	{
+		m_messageCallback((unsigned char const*)payload, numBytes);
 	}
-	return false;
 }
 
-bool NetWorkSystem::ProcessMessage()
+// The game thread's side of a new or lost connection: the next peer has to say hello again and gets the current state
+void NetWorkSystem::ResetConnectionState()
 {
-	while (!m_sendQueue.empty())
+	m_peerProtocolVersion = -1;
+	for (NetStateChannel& channel : m_stateChannels)
 	{
-		//m_sendBuffer = m_sendQueue[0].c_str();
-		const std::string& front = m_sendQueue.front();
-		int msgLength = (int)front.length();
-		int numBytesSent = 0;
-		while (numBytesSent < msgLength)
-		{
-			int numByteToSent = IntMin(msgLength - numBytesSent, m_config.m_recvBufferSize - 1);
-
-			memset(m_sendBuffer, 0, m_config.m_sendBufferSize);
+		channel.m_lastSent.clear();
+	}
+}
 
-			strncpy_s(m_sendBuffer, m_config.m_sendBufferSize, front.c_str() + numBytesSent, numByteToSent);
+//-----------------------------------------------------------------------------------------------
+// I/O thread
 
-			if (numBytesSent + numByteToSent >= msgLength)
+void NetWorkSystem::IOThreadMain()
+{
+	while (!m_isShuttingDown)
+	{
+		// Anything the game queues after this wakes the wait at the bottom again
+		m_wakeSocket.Drain();
+		m_isWakePending.exchange(false);
+
+		NetSocketHandle waitSocket = INVALID_NET_SOCKET;
+		bool waitForRead = false;
+		bool waitForWrite = false;
+		if (m_mode == NetMode::CLIENT)
+		{
+			// Keep trying the server until it answers, a refused attempt starts over on a fresh socket
+			if (m_clientState != ClientState::Connected)
 			{
-				m_sendBuffer[numByteToSent] = '\0';
-				numByteToSent++;
+				NetResult result = m_clientSocket.Connect(m_hostAddress);
+				if (result == NetResult::DONE)
+				{
+					m_clientState = ClientState::Connected;
+					PushNotice(NET_NOTICE_CONNECTED, Stringf("Connected to Server %s! Socket: %lld",
+						m_config.m_hostAddressString.c_str(), (long long)m_clientSocket.GetHandle()));
+				}
+				else if (result == NetResult::WOULD_BLOCK)
+				{
+					// Writable once the attempt is over, either way
+					waitSocket = m_clientSocket.GetHandle();
+					waitForWrite = true;
+				}
+				else
+				{
+					// Nothing to wait on, the next attempt comes after the full wait
+					CreateClientSocket();
+				}
 			}
 
-			int resultSent = send(m_clientSocket, m_sendBuffer, numByteToSent, 0);
-
-			if (resultSent == 0)
+			// Send and receive if we are connected.
+			if (m_clientState == ClientState::Connected)
 			{
-				shutdown(m_clientSocket, SD_BOTH);
-				closesocket(m_clientSocket);
-				m_clientSocket = INVALID_SOCKET;
-				return false;
+				int numBytesMoved = 0;
+				ProcessMessage(numBytesMoved);
 			}
-			if (resultSent == SOCKET_ERROR)
+		}
+		else if (m_mode == NetMode::SERVER)
+		{
+			// If we do not have a connection, check for connections to accept.
+			if (!m_clientSocket.IsOpen())
 			{
-				if (HandleErrors())
+				NetResult result = m_listenSocket.Accept(m_clientSocket);
+				if (result == NetResult::DONE)
 				{
-					return false;
+					PushNotice(NET_NOTICE_CONNECTED, Stringf("Connected to Client! Socket: %lld", (long long)m_clientSocket.GetHandle()));
 				}
+				else if (result == NetResult::FAILED)
+				{
+					PushNotice(NET_NOTICE_ERROR, Stringf("Accept failed, error code: %d", GetLastNetError()));
+				}
+			}
+			else
+			{
+				int numBytesMoved = 0;
+				ProcessMessage(numBytesMoved);
 			}
 
-			numBytesSent += resultSent;
+			if (!m_clientSocket.IsOpen())
+			{
+				waitSocket = m_listenSocket.GetHandle();
+				waitForRead = true;
+			}
 		}
-		m_sendQueue.pop_front();
+
+		// ProcessMessage moved all it could, so wait for room to send what is left and for more to read. With the
+		// receive ring full the socket stays readable, so reading waits until the game takes some inbound frames
+		bool isConnected = (m_mode == NetMode::CLIENT) ? (m_clientState == ClientState::Connected) : m_clientSocket.IsOpen();
+		if (isConnected)
+		{
+			waitSocket = m_clientSocket.GetHandle();
+			waitForRead = m_recvRing.GetNumFreeBytes() > 0;
+			waitForWrite = m_sendRing.GetNumBytes() > 0;
+		}
+		if (!m_isShuttingDown)
+		{
+			WaitForNetSockets(waitSocket, waitForRead, waitForWrite, m_wakeSocket, NET_IO_WAIT_MILLISECONDS);
+		}
+	}
+
+	// One last push of whatever the game queued before it shut down, a quit message most likely
+	bool isConnected = (m_mode == NetMode::CLIENT) ? (m_clientState == ClientState::Connected) : m_clientSocket.IsOpen();
+	if (m_mode != NetMode::NONE && isConnected)
+	{
+		int numBytesMoved = 0;
+		ProcessMessage(numBytesMoved);
+	}
+}
+
+// Notices must not get lost, so a game that has fallen this far behind holds the I/O thread up until it catches up
+void NetWorkSystem::PushNotice(unsigned char type, std::string const& text)
+{
+	std::string payload(1, (char)type);
+	payload.append(text);
+	while (!m_inboundQueue.WriteFrame(payload.data(), (int)payload.size()) && !m_isShuttingDown)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(NET_IO_WAIT_MILLISECONDS));
+	}
+}
+
+void NetWorkSystem::CreateAndBindServerSocket()
+{
+	if (!NetAddress::FromString(m_config.m_hostAddressString, m_hostAddress))
+	{
+		ERROR_AND_DIE(Stringf("Bad host address \"%s\", expected ip:port", m_config.m_hostAddressString.c_str()));
+	}
+
+	// The server listens on every address, only the port comes from the config
+	m_hostAddress.m_ip = 0;
+	if (!m_listenSocket.OpenTcp() || !m_listenSocket.Listen(m_hostAddress))
+	{
+		ERROR_AND_DIE(Stringf("Failed to listen on port %d, error code: %d", (int)m_hostAddress.m_port, GetLastNetError()));
+	}
+}
+
+void NetWorkSystem::CreateClientSocket()
+{
+	if (!NetAddress::FromString(m_config.m_hostAddressString, m_hostAddress))
+	{
+		ERROR_AND_DIE(Stringf("Bad host address \"%s\", expected ip:port", m_config.m_hostAddressString.c_str()));
+	}
+	if (!m_clientSocket.OpenTcp())
+	{
+		ERROR_AND_DIE(Stringf("Failed to create socket, error code: %d", GetLastNetError()));
+	}
+}
+
+void NetWorkSystem::CloseClientSocket()
+{
+	ResetConnectionBuffers();
+	if (m_mode == NetMode::SERVER)
+	{
+		m_clientSocket.Close();
+		PushNotice(NET_NOTICE_DISCONNECTED, "Client disconnected!");
 	}
+	else if (m_mode == NetMode::CLIENT)
+	{
+		m_clientState = ClientState::Disconnected;
+		PushNotice(NET_NOTICE_DISCONNECTED, Stringf("Disconnected from Server %s!", m_config.m_hostAddressString.c_str()));
+		CreateClientSocket();
+	}
+}
 
-	int resultRcv = recv(m_clientSocket, m_recvBuffer, m_config.m_recvBufferSize, 0);
+// A frame cut off mid-way would misalign the stream, so nothing buffered outlives the connection. The next one starts
+// with our hello, ahead of anything the game queues before it is up
+void NetWorkSystem::ResetConnectionBuffers()
+{
+	m_sendRing.Clear();
+	m_recvRing.Clear();
 
-	if (resultRcv > 0)
+	unsigned char hello[2] = { NET_MESSAGE_HELLO, m_config.m_protocolVersion };
+	m_sendRing.WriteFrame(hello, 2);
+}
+
+// True while the connection is still good; a lost or broken connection is closed here
+bool NetWorkSystem::HandleResult(NetResult result)
+{
+	if (result == NetResult::DONE || result == NetResult::WOULD_BLOCK)
 	{
-		m_recvQueue.append(m_recvBuffer, resultRcv);
-		memset(m_recvBuffer, 0, m_config.m_recvBufferSize);
+		return true;
+	}
+	if (result == NetResult::FAILED)
+	{
+		PushNotice(NET_NOTICE_ERROR, Stringf("Error code: %d", GetLastNetError()));
+	}
+	CloseClientSocket();
+	return false;
+}
 
-		size_t pos;
-		while ((pos = m_recvQueue.find('\0')) != std::string::npos)
+bool NetWorkSystem::ProcessMessage(int& out_numBytesMoved)
+{
+	// Top the send ring up from what the game queued and send straight out of it
+	for (;;)
+	{
+		char const* payload = nullptr;
+		int numPayloadBytes = 0;
+		while (m_outboundQueue.PeekFrame(payload, numPayloadBytes, m_frameScratch) == NetFrameResult::READY && m_sendRing.WriteFrame(payload, numPayloadBytes))
 		{
-			std::string completeMsg = m_recvQueue.substr(0, pos);
+			m_outboundQueue.ConsumeFrame(numPayloadBytes);
+		}
 
-			ExecuteRecvMessage(completeMsg);
+		int numBytesToSend = 0;
+		char const* sendSpan = m_sendRing.GetReadSpan(numBytesToSend);
+		if (numBytesToSend == 0)
+		{
+			break;
+		}
 
-			m_recvQueue.erase(0, pos + 1);
+		int numBytesSent = 0;
+		NetResult result = m_clientSocket.Send(sendSpan, numBytesToSend, numBytesSent);
+		if (!HandleResult(result))
+		{
+			return false;
 		}
+		if (result == NetResult::WOULD_BLOCK)
+		{
+			// The rest goes next pass
+			break;
+		}
+		m_sendRing.Consume(numBytesSent);
+		out_numBytesMoved += numBytesSent;
 	}
 
-	if (resultRcv == 0)
+	// Receive straight into the ring and decode after every read, until the socket has nothing more. A full ring
+	// means the game is behind on the inbound queue, the rest waits in the socket until it catches up
+	if (!DecodeFrames())
 	{
-		shutdown(m_clientSocket, SD_BOTH);
-		closesocket(m_clientSocket);
-		m_clientSocket = INVALID_SOCKET;
 		return false;
 	}
-	if (resultRcv == SOCKET_ERROR)
+	for (;;)
 	{
-		if (HandleErrors())
+		int numFreeBytes = 0;
+		char* recvSpan = m_recvRing.GetWriteSpan(numFreeBytes);
+		if (numFreeBytes == 0)
+		{
+			break;
+		}
+
+		int numBytesReceived = 0;
+		NetResult result = m_clientSocket.Receive(recvSpan, numFreeBytes, numBytesReceived);
+		m_recvRing.CommitWrite(numBytesReceived);
+		out_numBytesMoved += numBytesReceived;
+
+		if (!DecodeFrames() || !HandleResult(result))
 		{
 			return false;
 		}
+		if (result == NetResult::WOULD_BLOCK)
+		{
+			break;
+		}
 	}
+	return true;
+}
 
+// Moves every whole frame from the receive ring to the game's inbound queue, as far as the queue has room
+bool NetWorkSystem::DecodeFrames()
+{
+	for (;;)
+	{
+		char const* payload = nullptr;
+		int numBytes = 0;
+		NetFrameResult result = m_recvRing.PeekFrame(payload, numBytes, m_frameScratch);
+		if (result == NetFrameResult::NONE)
+		{
+			return true;
+		}
+		if (result == NetFrameResult::INVALID)
+		{
+			PushNotice(NET_NOTICE_ERROR, "Received a frame longer than any sender writes, dropping the connection");
+			HandleResult(NetResult::CLOSED);
+			return false;
+		}
 
-	return true;
-}
\ No newline at end of file
+		// Notices only ever come from this thread, one arriving from the peer is dropped
+		unsigned char type = (numBytes > 0) ? (unsigned char)payload[0] : NET_MESSAGE_HELLO;
+		bool isNotice = type >= NET_NOTICE_CONNECTED && type < FIRST_GAME_NET_MESSAGE;
+		if (!isNotice && !m_inboundQueue.WriteFrame(payload, numBytes))
+		{
+			return true;
+		}
+		m_recvRing.ConsumeFrame(numBytes);
+	}
+}
@@ -1,15 +1,24 @@
 #pragma once
 
-#define WIN32_LEAN_AND_MEAN	
-#include <windows.h>
-#include <winsock2.h>
-#include <ws2tcpip.h>
-#pragma comment(lib, "Ws2_32.lib")
-
+#include "Engine/Network/NetSocket.hpp"
+#include "Engine/Network/NetRingBuffer.hpp"
 #include "Engine/Core/StringUtils.hpp"
 #include "Engine/Core/EventSystem.hpp"
 #include "Engine/Core/DevConsole.hpp"
 #include <deque>
+#include <atomic>
+#include <thread>
+
+// First byte of every frame's payload. The engine owns the types below FIRST_GAME_NET_MESSAGE, the rest go to the
+// callback the game registers
+constexpr unsigned char NET_MESSAGE_HELLO = 0;		// Protocol version, always the first frame on a connection
+constexpr unsigned char NET_MESSAGE_CONSOLE = 1;	// Console command text, the debug fallback
+constexpr unsigned char NET_NOTICE_CONNECTED = 2;	// From the I/O thread to the game thread only, never on the wire
+constexpr unsigned char NET_NOTICE_DISCONNECTED = 3;
+constexpr unsigned char NET_NOTICE_ERROR = 4;
+constexpr unsigned char FIRST_GAME_NET_MESSAGE = 16;
+
+typedef void (*NetMessageCallbackFunction)(unsigned char const* payload, int numBytes);
 
 enum class NetMode
 {
@@ -30,11 +39,24 @@ struct NetworkConfig
 	bool m_isEnable = true;
 	std::string m_modeString;
 	std::string m_hostAddressString;
-	int m_sendBufferSize = 2048;
-	int m_recvBufferSize = 2048;
+	int m_sendBufferSize = 8192;	// Ring and queue sizes, at least one largest frame
+	int m_recvBufferSize = 8192;
+	unsigned char m_protocolVersion = 0;	// A peer on another version only gets console commands through
+	float m_stateSendRate = 20.f;			// Latest-value channel sends per second, 0 sends them every frame
 
 };
 
+// Idempotent state, like what the player is hovering, where only the newest value matters. Keyed by the message type
+struct NetStateChannel
+{
+	unsigned char m_type = 0;
+	std::string m_latest;
+	std::string m_lastSent;	// Empty until it goes out on this connection
+};
+
+// Sockets live on their own I/O thread, which connects, sends and receives and decodes frames. The game thread only
+// talks to it through two lock-free single producer, single consumer queues of whole messages, and only drains the
+// inbound one in BeginFrame, so a slow peer or a burst never shows up in frame time
 class NetWorkSystem
 {
 public:
@@ -51,7 +73,10 @@ public:
 	bool			IsServer() const;
 	bool			IsConnected() const;
 
-	void Send(std::string data);
+	void SetMessageCallback(NetMessageCallbackFunction callback);
+	void Send(void const* payload, int numBytes);	// One frame, at most MAX_NET_FRAME_PAYLOAD bytes, type byte first
+	void SendLatest(void const* payload, int numBytes);	// Replaces its type's pending state, sent at m_stateSendRate when it changed
+	void SendConsoleCommand(std::string const& command);
 
 	static bool RemoteCommand(EventArgs& args);
 	static bool BurstTest(EventArgs& args);
@@ -60,24 +85,46 @@ public:
 private:
 	NetworkConfig m_config;
 	NetMode m_mode;
-	ClientState  m_clientState = ClientState::Disconnected;
-	ClientState	m_lastFrameClientState = ClientState::Disconnected;
-	uintptr_t m_clientSocket;
-	uintptr_t m_listenSocket;
-	unsigned long m_hostAddress = 0;
-	unsigned short m_hostPort = 0;
-	char* m_sendBuffer;
-	char* m_recvBuffer;
-	std::deque<std::string> m_sendQueue;
-	std::string m_recvQueue;
+	std::atomic<ClientState> m_clientState = ClientState::Disconnected;
+	std::thread* m_ioThread = nullptr;
+	std::atomic<bool> m_isShuttingDown = false;
+	NetWakeSocket m_wakeSocket;				// The game thread wakes the I/O thread's socket wait when it queues frames
+	std::atomic<bool> m_isWakePending = false;
+
+	// Game thread
+	NetRingBuffer m_outboundQueue;			// Written here, read by the I/O thread
+	NetRingBuffer m_inboundQueue;			// Written by the I/O thread, read here
+	std::deque<std::string> m_sendOverflow;	// Whole payloads that didn't fit in m_outboundQueue, moved in as it drains
+	char* m_inboundScratch = nullptr;
+	NetMessageCallbackFunction m_messageCallback = nullptr;
+	int m_peerProtocolVersion = -1;			// Unknown until the peer's hello arrives
+	std::vector<NetStateChannel> m_stateChannels;
+	double m_lastStateSendSeconds = 0.0;
+
+	// I/O thread, once Startup has started it
+	NetSocket m_clientSocket;
+	NetSocket m_listenSocket;
+	NetAddress m_hostAddress;
+	NetRingBuffer m_sendRing;
+	NetRingBuffer m_recvRing;
+	char* m_frameScratch = nullptr;			// A payload that wraps around m_recvRing or m_outboundQueue, copied out
 
 protected:
-	void ExecuteRecvMessage(std::string const& message);
-	void InitializeWinsock();
+	void ExecuteRecvMessage(char const* payload, int numBytes);
+	void QueueFrame(void const* payload, int numBytes);
+	void WakeIOThread();
+	void FlushStateChannels();
+	void ResetConnectionState();
+
+	void IOThreadMain();
+	void PushNotice(unsigned char type, std::string const& text);
 	void CreateAndBindServerSocket();
-	bool HandleErrors();
 	void CreateClientSocket();
-	bool ProcessMessage();
+	void CloseClientSocket();
+	void ResetConnectionBuffers();
+	bool HandleResult(NetResult result);
+	bool ProcessMessage(int& out_numBytesMoved);
+	bool DecodeFrames();
 };
 
 extern NetWorkSystem* g_theNetwork;
\ No newline at end of file
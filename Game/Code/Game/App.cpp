@@ -3,6 +3,7 @@
 #include "Game/Game.hpp"
 #include "Game/Player.hpp"
 #include "Game/Map.hpp"
+#include "Game/GameMessages.hpp"
 
 
 App* g_theApp = nullptr;
@@ -75,10 +76,19 @@ void App::Startup(const char* commandLine)
 	NetworkConfig networkConfig;
 	networkConfig.m_modeString = g_gameConfigBlackboard.GetValue("netMode", "");
 	networkConfig.m_hostAddressString = g_gameConfigBlackboard.GetValue("netHostAddress", "");
-	networkConfig.m_sendBufferSize = g_gameConfigBlackboard.GetValue("netSendBufferSize", 2048);
-	networkConfig.m_recvBufferSize = g_gameConfigBlackboard.GetValue("netRecvBufferSize", 2048);
+	networkConfig.m_sendBufferSize = g_gameConfigBlackboard.GetValue("netSendBufferSize", 8192);
+	networkConfig.m_recvBufferSize = g_gameConfigBlackboard.GetValue("netRecvBufferSize", 8192);
+	networkConfig.m_stateSendRate = g_gameConfigBlackboard.GetValue("netStateSendRate", 20.f);
+	networkConfig.m_protocolVersion = GAME_PROTOCOL_VERSION;
 	g_theNetwork = new NetWorkSystem(networkConfig);
 
+	JobSystemConfig jobConfig;
+	jobConfig.m_numWorkers = g_gameConfigBlackboard.GetValue("jobWorkers", -1);
+	jobConfig.m_frameBudgetSeconds = g_gameConfigBlackboard.GetValue("jobFrameBudget", 0.f);
+	jobConfig.m_backgroundCutoffSeconds = g_gameConfigBlackboard.GetValue("jobBackgroundCutoff", 0.002f);
+	jobConfig.m_collectStats = g_gameConfigBlackboard.GetValue("jobCollectStats", false);
+	g_theJobSystem = new JobSystem(jobConfig);
+
 	m_game = new Game();
 
 	DebugRenderConfig debugrenderConfig;
@@ -93,6 +103,8 @@ void App::Startup(const char* commandLine)
 	g_theAudio->Startup();
 	g_theDevConsole->Startup();
 	g_theNetwork->Startup();
+	g_theJobSystem->Startup();
+	JobSystemCommandsStartup();
 
 	BitmapFont* font32 = g_theRenderer->CreateOrGetBitmapFont("Data/Fonts/RobotoMonoSemiBold32");
 	BitmapFont* font64 = g_theRenderer->CreateOrGetBitmapFont("Data/Fonts/RobotoMonoSemiBold64");
@@ -117,9 +129,7 @@ bool App::Event_Quit(EventArgs& args)
 {
 	UNUSED(args);
 
-	EventArgs arg;
-	arg.SetValue("command", Stringf("\"PlayerQuit id=%i\"", g_theApp->m_game->m_map->GetApplicationPlayerID()));
-	g_theNetwork->RemoteCommand(arg);
+	SendGameMessage(GameMessage(GameMessageType::PLAYER_QUIT, g_theApp->m_game->m_map->GetApplicationPlayerID()));
 
 	g_theApp->HandleQuitRequested();
 	return false;
@@ -141,6 +151,7 @@ bool App::Event_LoadGameConfig(EventArgs& args)
 void App::Shutdown()
 {
 	m_game->Shutdown();
+	g_theJobSystem->Shutdown();
 	g_UI->Shutdown();
 	g_theNetwork->Shutdown();
 	g_theDevConsole->Shutdown();
@@ -154,6 +165,8 @@ void App::Shutdown()
 	delete g_theRNG;
 	delete m_game;
 	m_game = nullptr;
+	delete g_theJobSystem;
+	g_theJobSystem = nullptr;
 	delete g_theNetwork;
 	g_theNetwork = nullptr;
 	delete g_theDevConsole;
@@ -204,6 +217,7 @@ void App::BeginFrame()
 	g_theAudio->BeginFrame();
 	g_theDevConsole->BeginFrame();
 	g_theNetwork->BeginFrame();
+	g_theJobSystem->BeginFrame();
 	g_UI->BeginFrame();
 }
 
@@ -255,6 +269,7 @@ void App::EndFrame()
 	g_theAudio->EndFrame();
 	g_theDevConsole->EndFrame();
 	g_theNetwork->EndFrame();
+	g_theJobSystem->EndFrame();
 	g_UI->EndFrame();
 }
 
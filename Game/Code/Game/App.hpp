@@ -13,6 +13,8 @@
 #include "Engine/Core/EngineCommon.hpp"
 #include "Engine/Renderer/DebugRender.hpp"
 #include "Engine/Network/NetworkSystem.hpp"
+#include "Engine/Core/JobSystem.hpp"
+#include "Engine/Core/JobSystemCommands.hpp"
 class Game;
 
 class App {
@@ -4,6 +4,7 @@
 #include "Game/Entity.hpp"
 #include "Game/Map.hpp"
 #include "Game/Unit.hpp"
+#include "Game/GameMessages.hpp"
 
 bool Game::Command_LoadMap(EventArgs& args)
 {
@@ -60,8 +61,7 @@ bool Game::Command_SetFocusedHex(EventArgs& args)
 bool Game::Command_SelectFocusedUnit(EventArgs& args)
 {
 	IntVec2 coords = args.GetValue("coords", IntVec2(-1, -1));
-	Tile* tile = g_theApp->m_game->m_map->GetTile(coords);
-	g_theApp->m_game->m_map->Select(tile);
+	g_theApp->m_game->m_map->Select(coords);
 	return true;
 }
 
@@ -102,8 +102,7 @@ bool Game::Command_HoldFire(EventArgs& args)
 bool Game::Command_Attack(EventArgs& args)
 {
 	IntVec2 coords = args.GetValue("coords", IntVec2(-1, -1));
-	Tile* tile = g_theApp->m_game->m_map->GetTile(coords);
-	g_theApp->m_game->m_map->Attack(tile);
+	g_theApp->m_game->m_map->Attack(coords);
 	return true;
 }
 
@@ -120,6 +119,64 @@ bool Game::Command_PlayerQuit(EventArgs& args)
 	return true;
 }
 
+// The typed messages the other player sends, doing what the matching console command does
+void Game::OnGameMessage(unsigned char const* payload, int numBytes)
+{
+	GameMessage message;
+	if (!DecodeGameMessage(payload, numBytes, message))
+	{
+		g_theDevConsole->AddLine(DevConsole::ERROR, Stringf("Dropped a malformed game message, type %d, %d bytes", (int)payload[0], numBytes));
+		return;
+	}
+
+	Map* map = g_theApp->m_game->m_map;
+
+	// The size check can't tell a bad coord from a good one, and a peer out of sync can name any tile
+	IntVec2 coords = message.m_coords;
+	IntVec2 gridSize = map->m_mapDef->m_gridSize;
+	if (DoesGameMessageHaveCoords(message.m_type) && (coords.x < 0 || coords.y < 0 || coords.x >= gridSize.x || coords.y >= gridSize.y))
+	{
+		g_theDevConsole->AddLine(DevConsole::ERROR, Stringf("Dropped a game message off the grid, type %d, coords %d,%d", (int)payload[0], coords.x, coords.y));
+		return;
+	}
+
+	switch (message.m_type)
+	{
+	case GameMessageType::PLAYER_READY:
+		map->SetPlayerReady(message.m_playerID);
+		break;
+	case GameMessageType::PLAYER_QUIT:
+		map->SetPlayerQuit(message.m_playerID);
+		break;
+	case GameMessageType::START_TURN:
+		map->StartTurn();
+		break;
+	case GameMessageType::END_TURN:
+		map->EndTurn();
+		break;
+	case GameMessageType::SET_FOCUSED_HEX:
+		map->m_currentFocusedCoord = message.m_coords;
+		break;
+	case GameMessageType::SELECT_FOCUSED_UNIT:
+		map->Select(message.m_coords);
+		break;
+	case GameMessageType::MOVE:
+		map->Move(message.m_coords);
+		break;
+	case GameMessageType::ATTACK:
+		map->Attack(message.m_coords);
+		break;
+	case GameMessageType::HOLD_FIRE:
+		map->HoldFire();
+		break;
+	case GameMessageType::CANCEL:
+		map->Cancel();
+		break;
+	default:
+		break;
+	}
+}
+
 Game::Game()
 {
 }
@@ -131,8 +188,8 @@ Game::~Game()
 //..............................
 void Game::Startup()
 {
-	UnitDefinitions::InitializeUnitDefs("Data/Definitions/UnitDefinitions.xml");
 	TileDefinition::InitializeTileDefs("Data/Definitions/TileDefinitions.xml");
+	UnitDefinitions::InitializeUnitDefs("Data/Definitions/UnitDefinitions.xml");
 	MapDefinition::InitializeMapDefs("Data/Definitions/MapDefinitions.xml");
 	g_theEventSystem->SubscribeEventCallbackFunction("LoadMap", Game::Command_LoadMap);
 	g_theEventSystem->SubscribeEventCallbackFunction("PlayerReady", Game::Command_PlayerReady);
@@ -148,6 +205,7 @@ void Game::Startup()
 	g_theEventSystem->SubscribeEventCallbackFunction("SelectPreviousUnit", Game::Command_SelectPreviousUnit);
 	g_theEventSystem->SubscribeEventCallbackFunction("SelectNextUnit", Game::Command_SelectNextUnit);
 	g_theEventSystem->SubscribeEventCallbackFunction("PlayerQuit", Game::Command_PlayerQuit);
+	g_theNetwork->SetMessageCallback(Game::OnGameMessage);
 
 	m_clock = new Clock(*Clock::s_theSystemClock);
 
@@ -253,9 +311,7 @@ void Game::Update(float deltaSeconds)
 			{
 				m_map->SetPlayerQuit(m_map->GetApplicationPlayerID());
 
-				EventArgs args;
-				args.SetValue("command", Stringf("\"PlayerQuit id=%i\"", m_map->GetApplicationPlayerID()));
-				g_theNetwork->RemoteCommand(args);
+				SendGameMessage(GameMessage(GameMessageType::PLAYER_QUIT, m_map->GetApplicationPlayerID()));
 				m_waitingPanel->SetActive(false);
 				m_mainMenuPanel->SetActive(true);
 
@@ -413,9 +469,7 @@ void Game::PlayNetworkGame()
 	m_map->SetPlayerReady(m_map->GetApplicationPlayerID());
 	m_map->m_currentPlayerIDTurn = 1;
 
-	EventArgs args;
-	args.SetValue("command", Stringf("\"PlayerReady id=%i\"", m_map->GetApplicationPlayerID()));
-	g_theNetwork->RemoteCommand(args);
+	SendGameMessage(GameMessage(GameMessageType::PLAYER_READY, m_map->GetApplicationPlayerID()));
 
 	m_mainMenuPanel->SetActive(false);
 	m_waitingPanel->SetActive(true);
@@ -451,9 +505,7 @@ void Game::BackToMenu()
 	{
 		m_map->SetPlayerQuit(m_map->GetApplicationPlayerID());
 
-		EventArgs args;
-		args.SetValue("command", Stringf("\"PlayerQuit id=%i\"", m_map->GetApplicationPlayerID()));
-		g_theNetwork->RemoteCommand(args);
+		SendGameMessage(GameMessage(GameMessageType::PLAYER_QUIT, m_map->GetApplicationPlayerID()));
 	}
 
 }
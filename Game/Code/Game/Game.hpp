@@ -35,6 +35,8 @@ public:
 	static bool Command_Attack(EventArgs& args);
 	static bool Command_Cancel(EventArgs& args);
 	static bool Command_PlayerQuit(EventArgs& args);
+
+	static void OnGameMessage(unsigned char const* payload, int numBytes);
 public:
 	Camera m_screenCamera;
 	Clock* m_clock = nullptr;
@@ -0,0 +1,606 @@
+#include "Game/GameDefinitions.hpp"
+#include "Game/HexRangeTable.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Math/FloatRange.hpp"
+#include <limits.h>
+#include <math.h>
+#include <stdlib.h>
+
+std::vector<TileDefinition*> TileDefinition::s_tileDefs;
+std::vector<UnitDefinitions*> UnitDefinitions::s_unitDefs;
+std::vector<MapDefinition*> MapDefinition::s_mapDefs;
+
+IntVec2 const HEX_NEIGHBOR_OFFSETS[NUM_HEX_NEIGHBORS] =
+{
+	IntVec2(0, 1), IntVec2(0, -1), IntVec2(1, 0), IntVec2(-1, 0), IntVec2(1, -1), IntVec2(-1, 1)
+};
+
+int GetHexDistance(IntVec2 a, IntVec2 b)
+{
+	// Axial coords, the third cube axis is -x - y
+	int deltaX = a.x - b.x;
+	int deltaY = a.y - b.y;
+	return (abs(deltaX) + abs(deltaY) + abs(deltaX + deltaY)) / 2;
+}
+
+Vec2 GetHexWorldPosition(IntVec2 coord)
+{
+	return Vec2(coord.x * 0.866f, 0.5f * coord.x + coord.y);
+}
+
+IntVec2 GetHexCoordAtWorldPosition(Vec2 worldPos)
+{
+	// Undo GetHexWorldPosition to get fractional axial coords, then round in cube space where the three
+	// coords must sum to zero: the one that moved furthest when rounding is rebuilt from the other two
+	float fractionalX = worldPos.x / 0.866f;
+	float fractionalY = worldPos.y - 0.5f * fractionalX;
+	float fractionalZ = -fractionalX - fractionalY;
+
+	float roundedX = roundf(fractionalX);
+	float roundedY = roundf(fractionalY);
+	float roundedZ = roundf(fractionalZ);
+
+	float deltaX = fabsf(roundedX - fractionalX);
+	float deltaY = fabsf(roundedY - fractionalY);
+	float deltaZ = fabsf(roundedZ - fractionalZ);
+	if (deltaX > deltaY && deltaX > deltaZ)
+	{
+		roundedX = -roundedY - roundedZ;
+	}
+	else if (deltaY > deltaZ)
+	{
+		roundedY = -roundedX - roundedZ;
+	}
+
+	return IntVec2((int)roundedX, (int)roundedY);
+}
+
+
+TileDefinition::TileDefinition(XmlElement& element)
+	:m_name(ParseXmlAttribute(element, "name", "Invalid")),
+	m_symbol(ParseXmlAttribute(element, "symbol", ' ')),
+	m_isBlocked(ParseXmlAttribute(element, "isBlocked", false)),
+	m_moveCost(ParseXmlAttribute(element, "moveCost", 1))
+{
+	GUARANTEE_OR_DIE(m_moveCost >= 1, "Tile moveCost must be at least 1");
+}
+
+void TileDefinition::InitializeTileDefs(char const* filePath)
+{
+	XmlDocument file;
+	XmlError result = file.LoadFile(filePath);
+	GUARANTEE_OR_DIE(result == tinyxml2::XML_SUCCESS, "FILE IS NOT LOADED");
+
+	XmlElement* rootElement = file.RootElement();
+	GUARANTEE_OR_DIE(rootElement, "Root Element is null");
+
+	XmlElement* tileDefElement = rootElement->FirstChildElement();
+
+	while (tileDefElement)
+	{
+		std::string name = tileDefElement->Name();
+		GUARANTEE_OR_DIE(name == "TileDefinition", "Root child element is in the wrong format");
+		TileDefinition* newTileDef = new TileDefinition(*tileDefElement);
+		s_tileDefs.push_back(newTileDef);
+		tileDefElement = tileDefElement->NextSiblingElement();
+	}
+}
+
+void TileDefinition::ClearDefinition()
+{
+	for (size_t i = 0; i < s_tileDefs.size(); i++)
+	{
+		if (s_tileDefs[i] != nullptr)
+		{
+			delete s_tileDefs[i];
+			s_tileDefs[i] = nullptr;
+		}
+	}
+}
+
+
+TileDefinition* TileDefinition::GetBySymbol(char symbol)
+{
+	for (size_t i = 0; i < s_tileDefs.size(); i++)
+	{
+		if (s_tileDefs[i]->m_symbol == symbol)
+		{
+			return s_tileDefs[i];
+		}
+	}
+	return nullptr;
+}
+
+TileDefinition* TileDefinition::GetByName(std::string const& name)
+{
+	for (size_t i = 0; i < s_tileDefs.size(); i++)
+	{
+		if (s_tileDefs[i]->m_name == name)
+		{
+			return s_tileDefs[i];
+		}
+	}
+	return nullptr;
+}
+
+unsigned int TileDefinition::GetType(TileDefinition* tileDef)
+{
+	for (unsigned int i = 0; i < s_tileDefs.size(); i++)
+	{
+		if (s_tileDefs[i] == tileDef)
+		{
+			return i;
+		}
+	}
+	ERROR_AND_DIE("Bad Index Type");
+}
+
+
+UnitDefinitions::UnitDefinitions(XmlElement& element)
+	:m_name(ParseXmlAttribute(element, "name", "")),
+	m_symbol(ParseXmlAttribute(element, "symbol", ' ')),
+	m_imageFilename(ParseXmlAttribute(element, "imageFilename", "")),
+	m_modelFilename(ParseXmlAttribute(element, "modelFilename", "")),
+	m_type(ParseXmlAttribute(element, "type", "")),
+	m_groundAttackDamage(ParseXmlAttribute(element, "groundAttackDamage", 0)),
+	m_groundAttackRangeMin(ParseXmlAttribute(element, "groundAttackRangeMin", 0)),
+	m_groundAttackRangeMax(ParseXmlAttribute(element, "groundAttackRangeMax", 0)),
+	m_movementRange(ParseXmlAttribute(element, "movementRange", 0)),
+	m_defense(ParseXmlAttribute(element, "defense", 0)),
+	m_health(ParseXmlAttribute(element, "health", 0)),
+	m_muzzlePosition(ParseXmlAttribute(element, "muzzlePosition", Vec3::ZERO)),
+	m_hitEffectName(ParseXmlAttribute(element, "hitEffectName", "")),
+	m_explosionEffectName(ParseXmlAttribute(element, "explosionEffectName", "")),
+	m_shotEffectName(ParseXmlAttribute(element, "shotEffectName", "")),
+	m_hitAudioFilename(ParseXmlAttribute(element, "hitAudioFilename", "")),
+	m_explosionAudioFilename(ParseXmlAttribute(element, "explosionAudioFilename", "")),
+	m_shotAudioFilename(ParseXmlAttribute(element, "shotAudioFilename", "")),
+	m_needsLineOfSight(ParseXmlAttribute(element, "needsLineOfSight", false))
+{
+	// Tile definitions are loaded first, a unit only lists the tiles it crosses differently, e.g. <TileMoveCost tile="Dirt" cost="2"/>
+	for (size_t i = 0; i < TileDefinition::s_tileDefs.size(); i++)
+	{
+		m_tileMoveCosts.push_back(TileDefinition::s_tileDefs[i]->m_moveCost);
+	}
+
+	XmlElement* moveCostElement = element.FirstChildElement("TileMoveCost");
+	while (moveCostElement)
+	{
+		std::string tileName = ParseXmlAttribute(*moveCostElement, "tile", "");
+		TileDefinition* tileDef = TileDefinition::GetByName(tileName);
+		GUARANTEE_OR_DIE(tileDef, Stringf("Unit %s has a TileMoveCost for unknown tile \"%s\"", m_name.c_str(), tileName.c_str()));
+
+		int moveCost = ParseXmlAttribute(*moveCostElement, "cost", tileDef->m_moveCost);
+		GUARANTEE_OR_DIE(moveCost >= 1, "TileMoveCost cost must be at least 1");
+		m_tileMoveCosts[TileDefinition::GetType(tileDef)] = moveCost;
+
+		moveCostElement = moveCostElement->NextSiblingElement("TileMoveCost");
+	}
+}
+
+bool UnitDefinitions::CanAttack(bool hasMovedThisTurn) const
+{
+	if (m_type == "Tank")
+	{
+		return true;
+	}
+	if (m_type == "Artillery")
+	{
+		return !hasMovedThisTurn;
+	}
+	return false;
+}
+
+int UnitDefinitions::GetDamageTaken(int attackDamage) const
+{
+	return (int)(2 * attackDamage / m_defense);
+}
+
+void UnitDefinitions::InitializeUnitDefs(char const* filePath)
+{
+	XmlDocument file;
+	XmlError result = file.LoadFile(filePath);
+	GUARANTEE_OR_DIE(result == tinyxml2::XML_SUCCESS, "FILE IS NOT LOADED");
+
+	XmlElement* rootElement = file.RootElement();
+	GUARANTEE_OR_DIE(rootElement, "Root Element is null");
+
+	XmlElement* unitDefElement = rootElement->FirstChildElement();
+
+	while (unitDefElement)
+	{
+		std::string name = unitDefElement->Name();
+		GUARANTEE_OR_DIE(name == "UnitDefinition", "Root child element is in the wrong format");
+		UnitDefinitions* newUnitDef = new UnitDefinitions(*unitDefElement);
+		s_unitDefs.push_back(newUnitDef);
+		unitDefElement = unitDefElement->NextSiblingElement();
+	}
+}
+
+void UnitDefinitions::ClearDefinition()
+{
+	for (size_t i = 0; i < s_unitDefs.size(); i++)
+	{
+		if (s_unitDefs[i] != nullptr)
+		{
+			delete s_unitDefs[i];
+			s_unitDefs[i] = nullptr;
+		}
+	}
+}
+
+UnitDefinitions* UnitDefinitions::GetByName(std::string const& name)
+{
+	for (size_t i = 0; i < s_unitDefs.size(); i++)
+	{
+		if (s_unitDefs[i]->m_name == name)
+		{
+			return s_unitDefs[i];
+		}
+	}
+	return nullptr;
+}
+
+UnitDefinitions* UnitDefinitions::GetBySymbol(char symbol)
+{
+	for (size_t i = 0; i < s_unitDefs.size(); i++)
+	{
+		if (s_unitDefs[i]->m_symbol == symbol)
+		{
+			return s_unitDefs[i];
+		}
+	}
+	return nullptr;
+}
+
+MapDefinition::MapDefinition(XmlElement& element)
+	:m_name(ParseXmlAttribute(element, "name", "")),
+	m_overlayShader(ParseXmlAttribute(element, "overlayShader", "")),
+	m_gridSize(ParseXmlAttribute(element, "gridSize", IntVec2())),
+	m_worldBoundsMin(ParseXmlAttribute(element, "worldBoundsMin", Vec3())),
+	m_worldBoundsMax(ParseXmlAttribute(element, "worldBoundsMax", Vec3()))
+{
+
+}
+
+void MapDefinition::SetUpTiles(XmlElement* element)
+{
+	std::string stringValue = element->GetText();
+	Strings row = SplitStringOnDelimiter(stringValue, '\n', false);
+
+	for (int rowIndex = (int)row.size() - 1; rowIndex >= 0; rowIndex--)
+	{
+		Strings column = SplitStringOnDelimiter(row[rowIndex], ' ', false);
+		for (int columnIndex = 0; columnIndex < column.size(); columnIndex++)
+		{
+			TileDefinition* tileDef = TileDefinition::GetBySymbol(*column[columnIndex].data());
+			unsigned int type = TileDefinition::GetType(tileDef);
+			GUARANTEE_OR_DIE(type <= TILE_TYPE_MASK, "Too many tile definitions for the tile grid flags");
+
+			unsigned char flags = (unsigned char)type;
+			if (tileDef->m_isBlocked)
+			{
+				flags |= TILE_FLAG_BLOCKED;
+			}
+			m_tiles.m_flags.push_back(flags);
+			m_tiles.m_occupants.push_back(NO_TILE_OCCUPANT);
+		}
+	}
+}
+
+void MapDefinition::SetUpUnits(XmlElement* element)
+{
+	int id = ParseXmlAttribute(*element, "player", 0);
+
+	std::string stringValue = element->GetText();
+	Strings row = SplitStringOnDelimiter(stringValue, '\n', false);
+
+	for (int rowIndex = (int)row.size() - 1; rowIndex >= 0; rowIndex--)
+	{
+		Strings column = SplitStringOnDelimiter(row[rowIndex], ' ', false);
+		for (int columnIndex = 0; columnIndex < column.size(); columnIndex++)
+		{
+			UnitDefinitions* unitDef = UnitDefinitions::GetBySymbol(*column[columnIndex].data());
+			if (unitDef)
+			{
+				m_units.push_back(UnitPlacement{ unitDef, id, IntVec2(columnIndex, (int)row.size() - 1 - rowIndex) });
+			}
+		}
+	}
+}
+
+void MapDefinition::SetUpTileBounds()
+{
+	GUARANTEE_OR_DIE((int)m_tiles.m_flags.size() == m_gridSize.x * m_gridSize.y, "Map tiles don't match the grid size");
+
+	// Baked into the flags once so walkability checks never redo the world space test
+	for (int tileIndex = 0; tileIndex < (int)m_tiles.m_flags.size(); tileIndex++)
+	{
+		if (!IsTileInWorldBounds(IntVec2(tileIndex % m_gridSize.x, tileIndex / m_gridSize.x)))
+		{
+			m_tiles.m_flags[tileIndex] |= TILE_FLAG_OUT_OF_BOUNDS;
+		}
+	}
+}
+
+bool MapDefinition::IsTileInWorldBounds(IntVec2 coord) const
+{
+	FloatRange xRange = FloatRange(m_worldBoundsMin.x, m_worldBoundsMax.x);
+	FloatRange yRange = FloatRange(m_worldBoundsMin.y, m_worldBoundsMax.y);
+
+	Vec2 worldPos = GetHexWorldPosition(coord);
+
+	return xRange.IsOnRange(worldPos.x) && yRange.IsOnRange(worldPos.y);
+}
+
+void MapDefinition::InitializeMapDefs(char const* filePath)
+{
+	XmlDocument file;
+	XmlError result = file.LoadFile(filePath);
+	GUARANTEE_OR_DIE(result == tinyxml2::XML_SUCCESS, "FILE IS NOT LOADED");
+
+	XmlElement* rootElement = file.RootElement();
+	GUARANTEE_OR_DIE(rootElement, "Root Element is null");
+
+
+	XmlElement* mapDefElement = rootElement->FirstChildElement();
+
+	while (mapDefElement)
+	{
+		std::string mapDefName = mapDefElement->Name();
+		GUARANTEE_OR_DIE(mapDefName == "MapDefinition", "Root child element is in the wrong format");
+		MapDefinition* newMapDef = new MapDefinition(*mapDefElement);
+
+		XmlElement* mapElements = mapDefElement->FirstChildElement();
+		while (mapElements)
+		{
+			std::string name = mapElements->Name();
+			if (name == "Tiles")
+			{
+				newMapDef->SetUpTiles(mapElements);
+			}
+			if (name == "Units")
+			{
+				newMapDef->SetUpUnits(mapElements);
+			}
+			mapElements = mapElements->NextSiblingElement();
+		}
+		newMapDef->SetUpTileBounds();
+
+		s_mapDefs.push_back(newMapDef);
+		mapDefElement = mapDefElement->NextSiblingElement();
+	}
+}
+
+void MapDefinition::ClearDefinition()
+{
+	for (size_t i = 0; i < s_mapDefs.size(); i++)
+	{
+		if (s_mapDefs[i] != nullptr)
+		{
+			s_mapDefs[i]->m_tiles.m_flags.clear();
+			s_mapDefs[i]->m_tiles.m_occupants.clear();
+			s_mapDefs[i]->m_units.clear();
+
+			delete s_mapDefs[i];
+			s_mapDefs[i] = nullptr;
+		}
+	}
+}
+
+
+MapDefinition* MapDefinition::GetByName(std::string const& name)
+{
+	for (size_t i = 0; i < s_mapDefs.size(); i++)
+	{
+		if (s_mapDefs[i]->m_name == name)
+		{
+			return s_mapDefs[i];
+		}
+	}
+	return nullptr;
+}
+
+int GetTileMoveCost(unsigned char tileFlags, UnitDefinitions const* unitDef)
+{
+	unsigned int type = tileFlags & TILE_TYPE_MASK;
+	if (unitDef)
+	{
+		return unitDef->m_tileMoveCosts[type];
+	}
+	return TileDefinition::s_tileDefs[type]->m_moveCost;
+}
+
+int GetMinTileMoveCost(UnitDefinitions const* unitDef)
+{
+	int minMoveCost = INT_MAX;
+	for (size_t type = 0; type < TileDefinition::s_tileDefs.size(); type++)
+	{
+		if (!TileDefinition::s_tileDefs[type]->m_isBlocked)
+		{
+			int moveCost = unitDef ? unitDef->m_tileMoveCosts[type] : TileDefinition::s_tileDefs[type]->m_moveCost;
+			if (moveCost < minMoveCost)
+			{
+				minMoveCost = moveCost;
+			}
+		}
+	}
+	return (minMoveCost == INT_MAX) ? 1 : minMoveCost;
+}
+
+int GetMaxTileMoveCost(UnitDefinitions const* unitDef)
+{
+	int maxMoveCost = 1;
+	for (size_t type = 0; type < TileDefinition::s_tileDefs.size(); type++)
+	{
+		if (!TileDefinition::s_tileDefs[type]->m_isBlocked)
+		{
+			int moveCost = unitDef ? unitDef->m_tileMoveCosts[type] : TileDefinition::s_tileDefs[type]->m_moveCost;
+			if (moveCost > maxMoveCost)
+			{
+				maxMoveCost = moveCost;
+			}
+		}
+	}
+	return maxMoveCost;
+}
+
+void PopulateMoveCosts(std::vector<int>& out_costs, MapDefinition const& mapDef, IntVec2 startCoord, UnitDefinitions const* unitDef,
+	bool useTileCosts, int costLimit, MoveCostScratch& scratch)
+{
+	std::vector<unsigned char> const& tileFlags = mapDef.m_tiles.m_flags;
+	IntVec2 gridSize = mapDef.m_gridSize;
+	int startIndex = startCoord.y * gridSize.x + startCoord.x;
+
+	out_costs.assign(tileFlags.size(), -1);
+	out_costs[startIndex] = 0;
+
+	int maxStepCost = useTileCosts ? GetMaxTileMoveCost(unitDef) : 1;
+	if (maxStepCost == 1)
+	{
+		// Every step costs 1, so tiles come off the queue in cost order and each one is settled on first touch
+		std::vector<int>& frontier = scratch.m_frontier;
+		frontier.clear();
+		frontier.push_back(startIndex);
+
+		for (size_t frontierIndex = 0; frontierIndex < frontier.size(); frontierIndex++)
+		{
+			int tileIndex = frontier[frontierIndex];
+			int nextCost = out_costs[tileIndex] + 1;
+			if (nextCost >= costLimit)
+			{
+				break;
+			}
+
+			IntVec2 tileCoord(tileIndex % gridSize.x, tileIndex / gridSize.x);
+			for (int neighbor = 0; neighbor < NUM_HEX_NEIGHBORS; neighbor++)
+			{
+				IntVec2 neighborCoord = tileCoord + HEX_NEIGHBOR_OFFSETS[neighbor];
+				if (neighborCoord.x < 0 || neighborCoord.y < 0 || neighborCoord.x >= gridSize.x || neighborCoord.y >= gridSize.y)
+				{
+					continue;
+				}
+				int neighborIndex = neighborCoord.y * gridSize.x + neighborCoord.x;
+				if (out_costs[neighborIndex] != -1 || (tileFlags[neighborIndex] & TILE_FLAGS_NOT_WALKABLE) != 0)
+				{
+					continue;
+				}
+				out_costs[neighborIndex] = nextCost;
+				frontier.push_back(neighborIndex);
+			}
+		}
+		return;
+	}
+
+	// Dial's algorithm: every cost is a whole number and a step adds at most maxStepCost, so the open tiles
+	// always fit in maxStepCost + 1 buckets indexed by cost modulo the bucket count, no heap needed.
+	// A tile lowered after it was bucketed is left behind in its old bucket and skipped there
+	int numBuckets = maxStepCost + 1;
+	std::vector<std::vector<int>>& buckets = scratch.m_buckets;
+	if ((int)buckets.size() < numBuckets)
+	{
+		buckets.resize(numBuckets);
+	}
+	for (int bucketIndex = 0; bucketIndex < numBuckets; bucketIndex++)
+	{
+		buckets[bucketIndex].clear();
+	}
+	buckets[0].push_back(startIndex);
+	int numOpen = 1;
+
+	for (int cost = 0; numOpen > 0; cost++)
+	{
+		std::vector<int>& bucket = buckets[cost % numBuckets];
+		for (size_t bucketIndex = 0; bucketIndex < bucket.size(); bucketIndex++)
+		{
+			int tileIndex = bucket[bucketIndex];
+			numOpen--;
+			if (out_costs[tileIndex] != cost)
+			{
+				continue;
+			}
+
+			IntVec2 tileCoord(tileIndex % gridSize.x, tileIndex / gridSize.x);
+			for (int neighbor = 0; neighbor < NUM_HEX_NEIGHBORS; neighbor++)
+			{
+				IntVec2 neighborCoord = tileCoord + HEX_NEIGHBOR_OFFSETS[neighbor];
+				if (neighborCoord.x < 0 || neighborCoord.y < 0 || neighborCoord.x >= gridSize.x || neighborCoord.y >= gridSize.y)
+				{
+					continue;
+				}
+				int neighborIndex = neighborCoord.y * gridSize.x + neighborCoord.x;
+				if ((tileFlags[neighborIndex] & TILE_FLAGS_NOT_WALKABLE) != 0)
+				{
+					continue;
+				}
+				int nextCost = cost + GetTileMoveCost(tileFlags[neighborIndex], unitDef);
+				if (nextCost >= costLimit)
+				{
+					continue;
+				}
+				if (out_costs[neighborIndex] != -1 && out_costs[neighborIndex] <= nextCost)
+				{
+					continue;
+				}
+				out_costs[neighborIndex] = nextCost;
+				buckets[nextCost % numBuckets].push_back(neighborIndex);
+				numOpen++;
+			}
+		}
+		bucket.clear();
+	}
+}
+
+bool IsTileInAttackRange(MapDefinition const& mapDef, HexRingTable const& rings, LineOfSightCache& lineOfSight,
+	UnitDefinitions const* unitDef, IntVec2 fromCoord, IntVec2 targetCoord)
+{
+	int distance = GetHexDistance(fromCoord, targetCoord);
+	if (distance < unitDef->m_groundAttackRangeMin || distance > unitDef->m_groundAttackRangeMax)
+	{
+		return false;
+	}
+	if (!unitDef->m_needsLineOfSight)
+	{
+		return true;
+	}
+
+	int offsetIndex = rings.GetOffsetIndex(targetCoord - fromCoord);
+	if (offsetIndex < 0)
+	{
+		return LineOfSightCache::TraceLineOfSight(&mapDef, fromCoord, targetCoord);
+	}
+	return lineOfSight.HasLineOfSight(fromCoord.y * mapDef.m_gridSize.x + fromCoord.x, offsetIndex);
+}
+
+void GetOccupantsInAttackRange(std::vector<int>& out_occupants, MapDefinition const& mapDef, std::vector<short> const& occupants,
+	HexRingTable const& rings, LineOfSightCache& lineOfSight, UnitDefinitions const* unitDef, IntVec2 fromCoord)
+{
+	int rangeMax = (unitDef->m_groundAttackRangeMax < rings.m_maxRange) ? unitDef->m_groundAttackRangeMax : rings.m_maxRange;
+	if (unitDef->m_groundAttackRangeMin > rangeMax)
+	{
+		return;
+	}
+
+	IntVec2 gridSize = mapDef.m_gridSize;
+	int fromIndex = fromCoord.y * gridSize.x + fromCoord.x;
+	for (int offsetIndex = rings.m_ringStarts[unitDef->m_groundAttackRangeMin]; offsetIndex < rings.m_ringStarts[rangeMax + 1]; offsetIndex++)
+	{
+		IntVec2 coord = fromCoord + rings.m_offsets[offsetIndex];
+		if (coord.x < 0 || coord.y < 0 || coord.x >= gridSize.x || coord.y >= gridSize.y)
+		{
+			continue;
+		}
+
+		short occupant = occupants[coord.y * gridSize.x + coord.x];
+		if (occupant == NO_TILE_OCCUPANT)
+		{
+			continue;
+		}
+		if (unitDef->m_needsLineOfSight && !lineOfSight.HasLineOfSight(fromIndex, offsetIndex))
+		{
+			continue;
+		}
+		out_occupants.push_back(occupant);
+	}
+}
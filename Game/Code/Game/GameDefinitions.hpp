@@ -0,0 +1,157 @@
+#pragma once
+#include "Engine/Core/XmlUtils.hpp"
+#include "Engine/Math/IntVec2.hpp"
+#include "Engine/Math/Vec2.hpp"
+#include "Engine/Math/Vec3.hpp"
+#include <string>
+#include <vector>
+
+// Definitions and hex grid math the game rules need, kept clear of the renderer, audio and UI headers so the
+// headless MatchSimulation builds on its own
+
+constexpr int NUM_HEX_NEIGHBORS = 6;
+
+// Axial neighbors in the order the pathfinding has always probed them
+extern IntVec2 const HEX_NEIGHBOR_OFFSETS[NUM_HEX_NEIGHBORS];
+
+int GetHexDistance(IntVec2 a, IntVec2 b);	// Steps between two tiles ignoring blocked ones
+Vec2 GetHexWorldPosition(IntVec2 coord);
+IntVec2 GetHexCoordAtWorldPosition(Vec2 worldPos);	// The hex containing worldPos, may be off the grid
+
+struct TileDefinition
+{
+	char m_symbol = ' ';
+	std::string m_name = " ";
+	bool m_isBlocked = false;
+	int m_moveCost = 1;	// Whole steps so distance fields can bucket by cost, units can override it per tile
+
+public:
+	TileDefinition(XmlElement& element);
+	static void InitializeTileDefs(char const* filePath);
+	static void ClearDefinition();
+	static TileDefinition* GetBySymbol(char symbol);
+	static TileDefinition* GetByName(std::string const& name);
+	static unsigned int GetType(TileDefinition* tileDef);
+	static std::vector<TileDefinition*> s_tileDefs;
+};
+
+struct UnitDefinitions
+{
+	char m_symbol = ' ';
+	std::string m_name = " ";
+	std::string m_imageFilename = " ";
+	std::string m_modelFilename = " ";
+	std::string m_type = " ";
+
+	Vec3 m_muzzlePosition;
+
+	std::string m_hitEffectName = " ";
+	std::string m_explosionEffectName = " ";
+	std::string m_shotEffectName = " ";
+
+	std::string m_hitAudioFilename = " ";
+	std::string m_explosionAudioFilename = " ";
+	std::string m_shotAudioFilename = " ";
+
+	int m_groundAttackDamage = 0;
+	int m_groundAttackRangeMin = 0;
+	int m_groundAttackRangeMax = 0;
+	int m_movementRange = 0;
+	int m_defense = 0;
+	int m_health = 0;
+	bool m_needsLineOfSight = false;	// Direct fire, a blocked tile between this unit and its target stops the shot
+
+	std::vector<int> m_tileMoveCosts;	// By tile type, TileDefinition::m_moveCost unless a TileMoveCost child overrides it
+
+public:
+	UnitDefinitions(XmlElement& element);
+
+	bool CanAttack(bool hasMovedThisTurn) const;	// Tanks fire on the move, artillery only where it started the turn
+	int GetDamageTaken(int attackDamage) const;	// What an attack of attackDamage takes off this unit's health
+
+	static void InitializeUnitDefs(char const* filePath);
+	static void ClearDefinition();
+	static UnitDefinitions* GetByName(std::string const& name);
+	static UnitDefinitions* GetBySymbol(char symbol);
+	static std::vector<UnitDefinitions*> s_unitDefs;
+};
+
+
+// Per-tile flags: the TileDefinition index in the low bits, plus bits for what keeps units off the tile
+constexpr unsigned char TILE_TYPE_MASK = 0x3f;
+constexpr unsigned char TILE_FLAG_OUT_OF_BOUNDS = 0x40;	// Outside the map's world bounds, set once the map is parsed
+constexpr unsigned char TILE_FLAG_BLOCKED = 0x80;
+constexpr unsigned char TILE_FLAGS_NOT_WALKABLE = TILE_FLAG_OUT_OF_BOUNDS | TILE_FLAG_BLOCKED;
+constexpr short NO_TILE_OCCUPANT = -1;
+
+// Tiles as parallel arrays indexed by Map::GetTileIndex, so grid walks read a byte or two per tile instead of
+// chasing a heap pointer. Occupants are indexes into Map::m_units
+struct TileGrid
+{
+	std::vector<unsigned char> m_flags;
+	std::vector<short> m_occupants;
+};
+
+// A unit as the map file places it at the start of a match
+struct UnitPlacement
+{
+	UnitDefinitions* m_unitDef = nullptr;
+	int m_playerID = 0;
+	IntVec2 m_coord;
+};
+
+struct MapDefinition
+{
+	std::string m_name = " ";
+	std::string m_overlayShader = " ";
+	IntVec2 m_gridSize;
+	Vec3 m_worldBoundsMin;
+	Vec3 m_worldBoundsMax;
+
+	TileGrid m_tiles;
+	std::vector<UnitPlacement> m_units;
+
+public:
+	MapDefinition(XmlElement& element);
+	void SetUpTiles(XmlElement* element);
+	void SetUpUnits(XmlElement* element);
+	void SetUpTileBounds();
+	bool IsTileInWorldBounds(IntVec2 coord) const;
+	static void InitializeMapDefs(char const* filePath);
+	static void ClearDefinition();
+	static MapDefinition* GetByName(std::string const& name);
+	static std::vector<MapDefinition*> s_mapDefs;
+};
+
+class HexRingTable;
+class LineOfSightCache;
+
+// Open tiles of the last move cost search, kept between searches so they don't allocate
+struct MoveCostScratch
+{
+	std::vector<int> m_frontier;
+	std::vector<std::vector<int>> m_buckets;
+};
+
+// Rules both Map and the headless MatchSimulation play by, over a map's tiles and an occupant per tile, each
+// an index into the caller's own units or NO_TILE_OCCUPANT
+
+int GetTileMoveCost(unsigned char tileFlags, UnitDefinitions const* unitDef);	// Tile defaults when unitDef is null
+// Over the tile types a unit can step on, tile defaults when unitDef is null. 1 when every type is blocked
+int GetMinTileMoveCost(UnitDefinitions const* unitDef);
+int GetMaxTileMoveCost(UnitDefinitions const* unitDef);
+
+// Move cost from startCoord to every tile, -1 where it is blocked, unreachable or costLimit away or further.
+// Breadth first with one step per tile, or Dial's bucketed Dijkstra over unitDef's move costs when useTileCosts
+// is set and they aren't all 1. Units never block movement
+void PopulateMoveCosts(std::vector<int>& out_costs, MapDefinition const& mapDef, IntVec2 startCoord, UnitDefinitions const* unitDef,
+	bool useTileCosts, int costLimit, MoveCostScratch& scratch);
+
+// Straight hex distance from fromCoord within unitDef's attack range, whatever lies between unless it needs line of sight
+bool IsTileInAttackRange(MapDefinition const& mapDef, HexRingTable const& rings, LineOfSightCache& lineOfSight,
+	UnitDefinitions const* unitDef, IntVec2 fromCoord, IntVec2 targetCoord);
+
+// Occupants a unit of unitDef could hit standing on fromCoord, found from rings without a grid walk. Appended
+// nearest ring first, whichever side they are on
+void GetOccupantsInAttackRange(std::vector<int>& out_occupants, MapDefinition const& mapDef, std::vector<short> const& occupants,
+	HexRingTable const& rings, LineOfSightCache& lineOfSight, UnitDefinitions const* unitDef, IntVec2 fromCoord);
@@ -0,0 +1,132 @@
+#include "Game/GameMessages.hpp"
+#include "Engine/Network/NetworkSystem.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+
+static unsigned char const s_gameMessageFields[] =
+{
+#define GAME_MESSAGE_FIELDS(type, fields, delivery) fields,
+	GAME_MESSAGE_LIST(GAME_MESSAGE_FIELDS)
+#undef GAME_MESSAGE_FIELDS
+};
+
+static GameMessageDelivery const s_gameMessageDeliveries[] =
+{
+#define GAME_MESSAGE_DELIVERY(type, fields, delivery) GameMessageDelivery::delivery,
+	GAME_MESSAGE_LIST(GAME_MESSAGE_DELIVERY)
+#undef GAME_MESSAGE_DELIVERY
+};
+
+static_assert(FIRST_GAME_NET_MESSAGE + (int)GameMessageType::COUNT <= 256, "Game message types overflow the type byte");
+
+static void WriteInt16(unsigned char*& bytes, int value)
+{
+	bytes[0] = (unsigned char)(value & 0xff);
+	bytes[1] = (unsigned char)((value >> 8) & 0xff);
+	bytes += 2;
+}
+
+static int ReadInt16(unsigned char const*& bytes)
+{
+	int value = (int)(short)(bytes[0] | (bytes[1] << 8));
+	bytes += 2;
+	return value;
+}
+
+//-----------------------------------------------------------------------------------------------
+GameMessage::GameMessage(GameMessageType type)
+	: m_type(type)
+{
+}
+
+GameMessage::GameMessage(GameMessageType type, int playerID)
+	: m_type(type)
+	, m_playerID(playerID)
+{
+}
+
+GameMessage::GameMessage(GameMessageType type, IntVec2 const& coords)
+	: m_type(type)
+	, m_coords(coords)
+{
+}
+
+//-----------------------------------------------------------------------------------------------
+int GetGameMessageSize(GameMessageType type)
+{
+	unsigned char fields = s_gameMessageFields[(int)type];
+	int size = 1;
+	if (fields & GAME_FIELDS_PLAYER_ID)
+	{
+		size += 1;
+	}
+	if (fields & GAME_FIELDS_COORDS)
+	{
+		size += 2 * 2;
+	}
+	return size;
+}
+
+bool DoesGameMessageHaveCoords(GameMessageType type)
+{
+	return (s_gameMessageFields[(int)type] & GAME_FIELDS_COORDS) != 0;
+}
+
+int EncodeGameMessage(GameMessage const& message, unsigned char* out_bytes)
+{
+	GUARANTEE_OR_DIE(message.m_type < GameMessageType::COUNT, "Encoding a game message with no type");
+
+	unsigned char fields = s_gameMessageFields[(int)message.m_type];
+	unsigned char* bytes = out_bytes;
+	*bytes++ = (unsigned char)(FIRST_GAME_NET_MESSAGE + (int)message.m_type);
+	if (fields & GAME_FIELDS_PLAYER_ID)
+	{
+		*bytes++ = (unsigned char)message.m_playerID;
+	}
+	if (fields & GAME_FIELDS_COORDS)
+	{
+		WriteInt16(bytes, message.m_coords.x);
+		WriteInt16(bytes, message.m_coords.y);
+	}
+	return (int)(bytes - out_bytes);
+}
+
+bool DecodeGameMessage(unsigned char const* bytes, int numBytes, GameMessage& out_message)
+{
+	if (numBytes < 1 || bytes[0] < FIRST_GAME_NET_MESSAGE || bytes[0] - FIRST_GAME_NET_MESSAGE >= (int)GameMessageType::COUNT)
+	{
+		return false;
+	}
+
+	out_message = GameMessage((GameMessageType)(bytes[0] - FIRST_GAME_NET_MESSAGE));
+	if (numBytes != GetGameMessageSize(out_message.m_type))
+	{
+		return false;
+	}
+
+	unsigned char fields = s_gameMessageFields[(int)out_message.m_type];
+	bytes++;
+	if (fields & GAME_FIELDS_PLAYER_ID)
+	{
+		out_message.m_playerID = (int)*bytes++;
+	}
+	if (fields & GAME_FIELDS_COORDS)
+	{
+		out_message.m_coords.x = ReadInt16(bytes);
+		out_message.m_coords.y = ReadInt16(bytes);
+	}
+	return true;
+}
+
+void SendGameMessage(GameMessage const& message)
+{
+	unsigned char bytes[MAX_GAME_MESSAGE_SIZE];
+	int numBytes = EncodeGameMessage(message, bytes);
+	if (s_gameMessageDeliveries[(int)message.m_type] == GameMessageDelivery::STATE)
+	{
+		g_theNetwork->SendLatest(bytes, numBytes);
+	}
+	else
+	{
+		g_theNetwork->Send(bytes, numBytes);
+	}
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include "Engine/Math/IntVec2.hpp"
+
+// Bump whenever a message is added, removed or changes fields; peers on different versions drop each other's messages
+constexpr unsigned char GAME_PROTOCOL_VERSION = 1;
+
+// What a message carries after its type byte, in this order
+constexpr unsigned char GAME_FIELDS_NONE = 0;
+constexpr unsigned char GAME_FIELDS_PLAYER_ID = 1 << 0;	// 1 byte
+constexpr unsigned char GAME_FIELDS_COORDS = 1 << 1;	// Two little-endian int16s
+
+// How a message reaches the peer. Actions are delivered in order, every one of them; state is latest-value-wins, sent
+// at the network's state rate and only when it changed
+enum class GameMessageDelivery : unsigned char
+{
+	ACTION,
+	STATE
+};
+
+// Every game command that crosses the network, the fields it carries and its delivery, each mirroring the console
+// command of the same name. Only ever append, the position is the wire type
+#define GAME_MESSAGE_LIST(MESSAGE) \
+	MESSAGE(PLAYER_READY,			GAME_FIELDS_PLAYER_ID,		ACTION) \
+	MESSAGE(PLAYER_QUIT,			GAME_FIELDS_PLAYER_ID,		ACTION) \
+	MESSAGE(START_TURN,				GAME_FIELDS_NONE,			ACTION) \
+	MESSAGE(END_TURN,				GAME_FIELDS_NONE,			ACTION) \
+	MESSAGE(SET_FOCUSED_HEX,		GAME_FIELDS_COORDS,			STATE) \
+	MESSAGE(SELECT_FOCUSED_UNIT,	GAME_FIELDS_COORDS,			ACTION) \
+	MESSAGE(MOVE,					GAME_FIELDS_COORDS,			ACTION) \
+	MESSAGE(ATTACK,					GAME_FIELDS_COORDS,			ACTION) \
+	MESSAGE(HOLD_FIRE,				GAME_FIELDS_NONE,			ACTION) \
+	MESSAGE(CANCEL,					GAME_FIELDS_NONE,			ACTION)
+
+enum class GameMessageType : unsigned char
+{
+#define GAME_MESSAGE_ENUM(type, fields, delivery) type,
+	GAME_MESSAGE_LIST(GAME_MESSAGE_ENUM)
+#undef GAME_MESSAGE_ENUM
+	COUNT
+};
+
+constexpr int MAX_GAME_MESSAGE_SIZE = 1 + 1 + 2 * 2;
+
+struct GameMessage
+{
+	GameMessage() = default;
+	explicit GameMessage(GameMessageType type);
+	GameMessage(GameMessageType type, int playerID);
+	GameMessage(GameMessageType type, IntVec2 const& coords);
+
+	GameMessageType m_type = GameMessageType::COUNT;
+	int m_playerID = 0;
+	IntVec2 m_coords = IntVec2(-1, -1);
+};
+
+int GetGameMessageSize(GameMessageType type);
+bool DoesGameMessageHaveCoords(GameMessageType type);
+int EncodeGameMessage(GameMessage const& message, unsigned char* out_bytes);	// Bytes written, out_bytes holds MAX_GAME_MESSAGE_SIZE
+bool DecodeGameMessage(unsigned char const* bytes, int numBytes, GameMessage& out_message);	// False for an unknown type or a wrong size
+
+void SendGameMessage(GameMessage const& message);
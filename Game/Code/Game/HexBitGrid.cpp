@@ -0,0 +1,151 @@
+#include "Game/HexBitGrid.hpp"
+#include <algorithm>
+
+// Bit x of a row moved to x + 1, pulling in the top bit of the word below it
+static unsigned long long GetRowWordShiftedUp(unsigned long long const* row, int wordIndex)
+{
+	unsigned long long carry = (wordIndex > 0) ? (row[wordIndex - 1] >> (HEX_BITS_PER_WORD - 1)) : 0;
+	return (row[wordIndex] << 1) | carry;
+}
+
+// Bit x of a row moved to x - 1, pulling in the bottom bit of the word above it
+static unsigned long long GetRowWordShiftedDown(unsigned long long const* row, int wordIndex, int wordsPerRow)
+{
+	unsigned long long carry = (wordIndex + 1 < wordsPerRow) ? (row[wordIndex + 1] << (HEX_BITS_PER_WORD - 1)) : 0;
+	return (row[wordIndex] >> 1) | carry;
+}
+
+HexBitGrid::HexBitGrid(IntVec2 gridSize)
+{
+	Resize(gridSize);
+}
+
+void HexBitGrid::Resize(IntVec2 gridSize)
+{
+	m_gridSize = gridSize;
+	m_wordsPerRow = (gridSize.x + HEX_BITS_PER_WORD - 1) / HEX_BITS_PER_WORD;
+	m_words.assign((size_t)m_wordsPerRow * gridSize.y, 0);
+}
+
+void HexBitGrid::ClearAll()
+{
+	std::fill(m_words.begin(), m_words.end(), 0);
+}
+
+void HexBitGrid::Set(IntVec2 coord)
+{
+	m_words[coord.y * m_wordsPerRow + coord.x / HEX_BITS_PER_WORD] |= 1ull << (coord.x % HEX_BITS_PER_WORD);
+}
+
+void HexBitGrid::Clear(IntVec2 coord)
+{
+	m_words[coord.y * m_wordsPerRow + coord.x / HEX_BITS_PER_WORD] &= ~(1ull << (coord.x % HEX_BITS_PER_WORD));
+}
+
+bool HexBitGrid::IsSet(IntVec2 coord) const
+{
+	return (m_words[coord.y * m_wordsPerRow + coord.x / HEX_BITS_PER_WORD] >> (coord.x % HEX_BITS_PER_WORD) & 1) != 0;
+}
+
+void HexBitGrid::CopyFrom(HexBitGrid const& other)
+{
+	m_gridSize = other.m_gridSize;
+	m_wordsPerRow = other.m_wordsPerRow;
+	m_words.assign(other.m_words.begin(), other.m_words.end());
+}
+
+void HexBitGrid::Or(HexBitGrid const& other)
+{
+	for (size_t i = 0; i < m_words.size(); i++)
+	{
+		m_words[i] |= other.m_words[i];
+	}
+}
+
+void HexBitGrid::And(HexBitGrid const& other)
+{
+	for (size_t i = 0; i < m_words.size(); i++)
+	{
+		m_words[i] &= other.m_words[i];
+	}
+}
+
+void HexBitGrid::AndNot(HexBitGrid const& other)
+{
+	for (size_t i = 0; i < m_words.size(); i++)
+	{
+		m_words[i] &= ~other.m_words[i];
+	}
+}
+
+bool HexBitGrid::IsEqual(HexBitGrid const& other) const
+{
+	return m_words == other.m_words;
+}
+
+void HexBitGrid::DilateInto(HexBitGrid& out_dilated, HexBitGrid const& mask) const
+{
+	if (out_dilated.m_gridSize != m_gridSize)
+	{
+		out_dilated.Resize(m_gridSize);
+	}
+
+	for (int y = 0; y < m_gridSize.y; y++)
+	{
+		unsigned long long const* row = &m_words[y * m_wordsPerRow];
+		unsigned long long const* rowBelow = (y > 0) ? row - m_wordsPerRow : nullptr;
+		unsigned long long const* rowAbove = (y + 1 < m_gridSize.y) ? row + m_wordsPerRow : nullptr;
+		unsigned long long const* maskRow = &mask.m_words[y * m_wordsPerRow];
+		unsigned long long* outRow = &out_dilated.m_words[y * m_wordsPerRow];
+
+		for (int wordIndex = 0; wordIndex < m_wordsPerRow; wordIndex++)
+		{
+			// (x-1, y), (x+1, y) and the tile itself
+			unsigned long long bits = row[wordIndex] | GetRowWordShiftedUp(row, wordIndex) | GetRowWordShiftedDown(row, wordIndex, m_wordsPerRow);
+			if (rowBelow)
+			{
+				// (x, y-1) and (x+1, y-1)
+				bits |= rowBelow[wordIndex] | GetRowWordShiftedDown(rowBelow, wordIndex, m_wordsPerRow);
+			}
+			if (rowAbove)
+			{
+				// (x, y+1) and (x-1, y+1)
+				bits |= rowAbove[wordIndex] | GetRowWordShiftedUp(rowAbove, wordIndex);
+			}
+			outRow[wordIndex] = bits & maskRow[wordIndex];
+		}
+	}
+}
+
+void HexBitGrid::PopulateStepLayers(std::vector<HexBitGrid>& out_layers, IntVec2 start, int maxSteps, HexBitGrid const& walkable)
+{
+	out_layers.resize(maxSteps + 1);
+	for (size_t i = 0; i < out_layers.size(); i++)
+	{
+		if (out_layers[i].m_gridSize != walkable.m_gridSize)
+		{
+			out_layers[i].Resize(walkable.m_gridSize);
+		}
+	}
+
+	out_layers[0].ClearAll();
+	out_layers[0].Set(start);
+
+	// Each layer grows straight out of the one before it, so once out_layers has its size nothing touches the heap
+	for (int step = 1; step <= maxSteps; step++)
+	{
+		HexBitGrid const& previous = out_layers[step - 1];
+		previous.DilateInto(out_layers[step], walkable);
+		out_layers[step].Or(previous);
+
+		if (out_layers[step].IsEqual(previous))
+		{
+			// Nothing new came in, so nothing new ever will
+			for (int restStep = step + 1; restStep <= maxSteps; restStep++)
+			{
+				out_layers[restStep].CopyFrom(previous);
+			}
+			return;
+		}
+	}
+}
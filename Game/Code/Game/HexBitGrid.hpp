@@ -0,0 +1,39 @@
+#pragma once
+#include "Engine/Math/IntVec2.hpp"
+#include <vector>
+
+constexpr int HEX_BITS_PER_WORD = 64;
+
+// One bit per tile, each grid row packed into whole 64 bit words so a row shift moves 64 tiles at once.
+// Neighbors follow HEX_NEIGHBOR_OFFSETS: x +-1 is a shift within the row, y +-1 is the row above or below,
+// and the two diagonals are the row below shifted down in x and the row above shifted up in x
+class HexBitGrid
+{
+public:
+	HexBitGrid() = default;
+	explicit HexBitGrid(IntVec2 gridSize);
+
+	void Resize(IntVec2 gridSize);	// Also clears every bit
+	void ClearAll();
+	void Set(IntVec2 coord);
+	void Clear(IntVec2 coord);
+	bool IsSet(IntVec2 coord) const;
+
+	void CopyFrom(HexBitGrid const& other);
+	void Or(HexBitGrid const& other);
+	void And(HexBitGrid const& other);
+	void AndNot(HexBitGrid const& other);
+	bool IsEqual(HexBitGrid const& other) const;
+
+	// out = every set tile and its six neighbors, limited to the tiles set in mask
+	void DilateInto(HexBitGrid& out_dilated, HexBitGrid const& mask) const;
+
+	// out_layers[n] = the tiles within n steps of start, one step per tile, going through walkable tiles only.
+	// Same tiles the breadth first Map::PopulateDistanceField puts at n or less
+	static void PopulateStepLayers(std::vector<HexBitGrid>& out_layers, IntVec2 start, int maxSteps, HexBitGrid const& walkable);
+
+public:
+	IntVec2 m_gridSize;
+	int m_wordsPerRow = 0;
+	std::vector<unsigned long long> m_words;
+};
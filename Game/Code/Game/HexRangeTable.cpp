@@ -0,0 +1,104 @@
+#include "Game/HexRangeTable.hpp"
+
+void HexRingTable::Build(int maxRange)
+{
+	m_maxRange = maxRange;
+	m_offsets.clear();
+	m_ringStarts.clear();
+
+	for (int range = 0; range <= maxRange; range++)
+	{
+		m_ringStarts.push_back((int)m_offsets.size());
+		for (int y = -range; y <= range; y++)
+		{
+			for (int x = -range; x <= range; x++)
+			{
+				IntVec2 offset(x, y);
+				if (GetHexDistance(IntVec2(0, 0), offset) == range)
+				{
+					m_offsets.push_back(offset);
+				}
+			}
+		}
+	}
+	m_ringStarts.push_back((int)m_offsets.size());
+
+	int side = 2 * maxRange + 1;
+	m_offsetIndexes.assign(side * side, -1);
+	for (int offsetIndex = 0; offsetIndex < (int)m_offsets.size(); offsetIndex++)
+	{
+		IntVec2 offset = m_offsets[offsetIndex];
+		m_offsetIndexes[(offset.y + maxRange) * side + offset.x + maxRange] = offsetIndex;
+	}
+}
+
+int HexRingTable::GetOffsetIndex(IntVec2 offset) const
+{
+	if (offset.x < -m_maxRange || offset.x > m_maxRange || offset.y < -m_maxRange || offset.y > m_maxRange)
+	{
+		return -1;
+	}
+	int side = 2 * m_maxRange + 1;
+	return m_offsetIndexes[(offset.y + m_maxRange) * side + offset.x + m_maxRange];
+}
+
+void LineOfSightCache::Invalidate(MapDefinition const* mapDef, HexRingTable const* rings)
+{
+	m_mapDef = mapDef;
+	m_rings = rings;
+	m_wordsPerTile = ((int)rings->m_offsets.size() + 63) / 64;
+
+	int numTiles = mapDef->m_gridSize.x * mapDef->m_gridSize.y;
+	m_visibleBits.assign((size_t)numTiles * m_wordsPerTile, 0);
+	m_isTilePopulated.assign(numTiles, 0);
+}
+
+bool LineOfSightCache::HasLineOfSight(int fromTileIndex, int offsetIndex)
+{
+	if (!m_isTilePopulated[fromTileIndex])
+	{
+		PopulateTile(fromTileIndex);
+	}
+	unsigned long long word = m_visibleBits[fromTileIndex * m_wordsPerTile + offsetIndex / 64];
+	return ((word >> (offsetIndex % 64)) & 1) != 0;
+}
+
+bool LineOfSightCache::TraceLineOfSight(MapDefinition const* mapDef, IntVec2 from, IntVec2 to)
+{
+	// Sample the straight line between tile centers once per step. The nudge keeps samples off the edges
+	// between two hexes, so a line running along an edge always lands on the same side
+	int numSteps = GetHexDistance(from, to);
+	Vec2 fromPos = GetHexWorldPosition(from) + Vec2(0.0001f, 0.0002f);
+	Vec2 toPos = GetHexWorldPosition(to) + Vec2(0.0001f, 0.0002f);
+	IntVec2 gridSize = mapDef->m_gridSize;
+
+	for (int step = 1; step < numSteps; step++)
+	{
+		float fraction = (float)step / (float)numSteps;
+		IntVec2 coord = GetHexCoordAtWorldPosition(fromPos + (toPos - fromPos) * fraction);
+		if (coord.x < 0 || coord.y < 0 || coord.x >= gridSize.x || coord.y >= gridSize.y)
+		{
+			continue;
+		}
+		if ((mapDef->m_tiles.m_flags[coord.y * gridSize.x + coord.x] & TILE_FLAG_BLOCKED) != 0)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void LineOfSightCache::PopulateTile(int fromTileIndex)
+{
+	IntVec2 from(fromTileIndex % m_mapDef->m_gridSize.x, fromTileIndex / m_mapDef->m_gridSize.x);
+	unsigned long long* bits = &m_visibleBits[fromTileIndex * m_wordsPerTile];
+
+	for (int offsetIndex = 0; offsetIndex < (int)m_rings->m_offsets.size(); offsetIndex++)
+	{
+		if (TraceLineOfSight(m_mapDef, from, from + m_rings->m_offsets[offsetIndex]))
+		{
+			bits[offsetIndex / 64] |= 1ull << (offsetIndex % 64);
+		}
+	}
+	m_isTilePopulated[fromTileIndex] = 1;
+}
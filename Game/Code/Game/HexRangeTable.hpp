@@ -0,0 +1,37 @@
+#pragma once
+#include "Game/GameDefinitions.hpp"
+
+// Every axial offset out to m_maxRange, nearest ring first: ring n is the 6n offsets exactly n steps away,
+// stored from m_ringStarts[n] up to m_ringStarts[n + 1]. Ring 0 is the tile itself
+class HexRingTable
+{
+public:
+	void Build(int maxRange);
+	int GetOffsetIndex(IntVec2 offset) const;	// -1 past m_maxRange
+
+public:
+	int m_maxRange = -1;
+	std::vector<IntVec2> m_offsets;
+	std::vector<int> m_ringStarts;
+	std::vector<int> m_offsetIndexes;	// Square of side 2 * m_maxRange + 1 centered on offset 0, -1 in its corners
+};
+
+// Which tiles of a HexRingTable disc each tile can see, one bit per offset. A tile's bits are worked out the first
+// time it is asked about and kept until Invalidate, which only needs calling when tile types change
+class LineOfSightCache
+{
+public:
+	void Invalidate(MapDefinition const* mapDef, HexRingTable const* rings);
+	bool HasLineOfSight(int fromTileIndex, int offsetIndex);
+
+	static bool TraceLineOfSight(MapDefinition const* mapDef, IntVec2 from, IntVec2 to);	// Uncached, no blocked tile strictly between
+
+private:
+	void PopulateTile(int fromTileIndex);
+
+	MapDefinition const* m_mapDef = nullptr;
+	HexRingTable const* m_rings = nullptr;
+	int m_wordsPerTile = 0;
+	std::vector<unsigned long long> m_visibleBits;
+	std::vector<unsigned char> m_isTilePopulated;
+};
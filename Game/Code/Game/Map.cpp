@@ -2,216 +2,10 @@
 #include "Game/Game.hpp"
 #include "Game/Unit.hpp"
 #include "Game/Player.hpp"
-
-std::vector<TileDefinition*> TileDefinition::s_tileDefs;
-std::vector<MapDefinition*> MapDefinition::s_mapDefs;
-
-
-TileDefinition::TileDefinition(XmlElement& element)
-	:m_name(ParseXmlAttribute(element, "name", "Invalid")),
-	m_symbol(ParseXmlAttribute(element, "symbol", ' ')),
-	m_isBlocked(ParseXmlAttribute(element, "isBlocked", false))
-{
-
-}
-
-void TileDefinition::InitializeTileDefs(char const* filePath)
-{
-	XmlDocument file;
-	XmlError result = file.LoadFile(filePath);
-	GUARANTEE_OR_DIE(result == tinyxml2::XML_SUCCESS, "FILE IS NOT LOADED");
-
-	XmlElement* rootElement = file.RootElement();
-	GUARANTEE_OR_DIE(rootElement, "Root Element is null");
-
-	XmlElement* tileDefElement = rootElement->FirstChildElement();
-
-	while (tileDefElement)
-	{
-		std::string name = tileDefElement->Name();
-		GUARANTEE_OR_DIE(name == "TileDefinition", "Root child element is in the wrong format");
-		TileDefinition* newTileDef = new TileDefinition(*tileDefElement);
-		s_tileDefs.push_back(newTileDef);
-		tileDefElement = tileDefElement->NextSiblingElement();
-	}
-}
-
-void TileDefinition::ClearDefinition()
-{
-	for (size_t i = 0; i < s_tileDefs.size(); i++)
-	{
-		if (s_tileDefs[i] != nullptr)
-		{
-			delete s_tileDefs[i];
-			s_tileDefs[i] = nullptr;
-		}
-	}
-}
-
-
-TileDefinition* TileDefinition::GetBySymbol(char symbol)
-{
-	for (size_t i = 0; i < s_tileDefs.size(); i++)
-	{
-		if (s_tileDefs[i]->m_symbol == symbol)
-		{
-			return s_tileDefs[i];
-		}
-	}
-	return nullptr;
-}
-
-unsigned int TileDefinition::GetType(TileDefinition* tileDef)
-{
-	for (unsigned int i = 0; i < s_tileDefs.size(); i++)
-	{
-		if (s_tileDefs[i] == tileDef)
-		{
-			return i;
-		}
-	}
-	ERROR_AND_DIE("Bad Index Type");
-}
-
-MapDefinition::MapDefinition(XmlElement& element)
-	:m_name(ParseXmlAttribute(element, "name", "")),
-	m_overlayShader(ParseXmlAttribute(element, "overlayShader", "")),
-	m_gridSize(ParseXmlAttribute(element, "gridSize", IntVec2())),
-	m_worldBoundsMin(ParseXmlAttribute(element, "worldBoundsMin", Vec3())),
-	m_worldBoundsMax(ParseXmlAttribute(element, "worldBoundsMax", Vec3()))
-{
-
-}
-
-void MapDefinition::SetUpTiles(XmlElement* element)
-{
-	std::string stringValue = element->GetText();
-	Strings row = SplitStringOnDelimiter(stringValue, '\n', false);
-
-	for (int rowIndex = (int)row.size() - 1; rowIndex >= 0; rowIndex--)
-	{
-		Strings column = SplitStringOnDelimiter(row[rowIndex], ' ', false);
-		for (int columnIndex = 0; columnIndex < column.size(); columnIndex++)
-		{
-			TileDefinition* tileDef = TileDefinition::GetBySymbol(*column[columnIndex].data());
-			Tile* newTile = new Tile(tileDef);
-			m_tiles.push_back(newTile);
-		}
-	}
-}
-
-void MapDefinition::SetUpUnits(XmlElement* element)
-{
-	int id = ParseXmlAttribute(*element, "player", 0);
-
-	std::string stringValue = element->GetText();
-	Strings row = SplitStringOnDelimiter(stringValue, '\n', false);
-
-	for (int rowIndex = (int)row.size() - 1; rowIndex >= 0; rowIndex--)
-	{
-		Strings column = SplitStringOnDelimiter(row[rowIndex], ' ', false);
-		for (int columnIndex = 0; columnIndex < column.size(); columnIndex++)
-		{
-			UnitDefinitions* unitDef = UnitDefinitions::GetBySymbol(*column[columnIndex].data());
-			if (unitDef)
-			{
-				Unit* newUnit = new Unit(unitDef, id, IntVec2(columnIndex, (int)row.size() - 1 - rowIndex));
-				m_units.push_back(newUnit);
-			}
-		}
-	}
-}
-
-void MapDefinition::InitializeMapDefs(char const* filePath)
-{
-	XmlDocument file;
-	XmlError result = file.LoadFile(filePath);
-	GUARANTEE_OR_DIE(result == tinyxml2::XML_SUCCESS, "FILE IS NOT LOADED");
-
-	XmlElement* rootElement = file.RootElement();
-	GUARANTEE_OR_DIE(rootElement, "Root Element is null");
-
-
-	XmlElement* mapDefElement = rootElement->FirstChildElement();
-
-	while (mapDefElement)
-	{
-		std::string mapDefName = mapDefElement->Name();
-		GUARANTEE_OR_DIE(mapDefName == "MapDefinition", "Root child element is in the wrong format");
-		MapDefinition* newMapDef = new MapDefinition(*mapDefElement);
-
-		XmlElement* mapElements = mapDefElement->FirstChildElement();
-		while (mapElements)
-		{
-			std::string name = mapElements->Name();
-			if (name == "Tiles")
-			{
-				newMapDef->SetUpTiles(mapElements);
-			}
-			if (name == "Units")
-			{
-				newMapDef->SetUpUnits(mapElements);
-			}
-			mapElements = mapElements->NextSiblingElement();
-		}
-
-		s_mapDefs.push_back(newMapDef);
-		mapDefElement = mapDefElement->NextSiblingElement();
-	}
-}
-
-void MapDefinition::ClearDefinition()
-{
-	for (size_t i = 0; i < s_mapDefs.size(); i++)
-	{
-		if (s_mapDefs[i] != nullptr)
-		{
-			for (size_t t = 0; t < s_mapDefs[i]->m_tiles.size(); t++)
-			{
-				delete s_mapDefs[i]->m_tiles[t];
-				s_mapDefs[i]->m_tiles[t] = nullptr;
-			}
-
-			for (size_t u = 0; u < s_mapDefs[i]->m_units.size(); u++)
-			{
-				delete s_mapDefs[i]->m_units[u];
-				s_mapDefs[i]->m_units[u] = nullptr;
-			}
-
-			s_mapDefs[i]->m_tiles.clear();
-			s_mapDefs[i]->m_units.clear();
-
-			delete s_mapDefs[i];
-			s_mapDefs[i] = nullptr;
-		}
-	}
-}
-
-
-MapDefinition* MapDefinition::GetByName(std::string const& name)
-{
-	for (size_t i = 0; i < s_mapDefs.size(); i++)
-	{
-		if (s_mapDefs[i]->m_name == name)
-		{
-			return s_mapDefs[i];
-		}
-	}
-	return nullptr;
-}
-
-
-Tile::Tile(TileDefinition* tileDef)
-{
-	m_type = TileDefinition::GetType(tileDef);
-}
-
-Tile::Tile(unsigned int type)
-	:m_type(type)
-{
-
-}
-
+#include "Game/ReachabilityCache.hpp"
+#include "Game/GameMessages.hpp"
+#include <algorithm>
+#include <math.h>
 
 Map::Map(Game* owner)
 	:m_game(owner)
@@ -316,6 +110,12 @@ void Map::Shutdown()
 	delete m_GridIndexBuffer;
 	m_GridIndexBuffer = nullptr;
 
+	delete m_reachabilityCache;
+	m_reachabilityCache = nullptr;
+
+	delete m_heatMap;
+	m_heatMap = nullptr;
+
 	for (size_t i = 0; i < m_units.size(); i++)
 	{
 		m_units[i].Shutdown();
@@ -333,92 +133,66 @@ void Map::DeleteGridData()
 	m_overlayShader = nullptr;
 }
 
-void Map::PopulateDistanceField(TileHeatMap& out_distanceField, IntVec2 startCoords, float maxCost) const
+void Map::PopulateDistanceField(TileHeatMap& out_distanceField, IntVec2 startCoords, float maxCost, bool useTileCosts) const
 {
-	TileHeatMap& distField = out_distanceField;
-	distField.SetHeaEverywhere(maxCost);
-	distField.SetHeatAt(startCoords, 0.f);
+	Unit const* mover = GetTileUnit(GetTileIndex(startCoords.x, startCoords.y));
+	UnitDefinitions const* moverDef = mover ? mover->m_unitDef : nullptr;
+	PopulateMoveCosts(m_moveCosts, *m_mapDef, startCoords, moverDef, useTileCosts, (int)ceilf(maxCost), m_moveScratch);
 
-	float currentValue = 0.f;
-	bool isDirty = true;
-	while (isDirty)
+	std::vector<float>& heat = out_distanceField.m_values;
+	for (size_t tileIndex = 0; tileIndex < m_moveCosts.size(); tileIndex++)
 	{
-		isDirty = false;
-		float nextValue = currentValue + 1.f;
-		for (int tileY = 0; tileY < m_mapDef->m_gridSize.y; ++tileY)
-		{
-			for (int tileX = 0; tileX < m_mapDef->m_gridSize.x; ++tileX)
-			{
-				IntVec2 tileCoord = IntVec2(tileX, tileY);
-				if (distField.GetHeatAt(tileCoord) == currentValue)
-				{
-					SetHeatIfLessAndNonSolid(isDirty, distField, tileCoord + IntVec2(0, 1), nextValue);
-					SetHeatIfLessAndNonSolid(isDirty, distField, tileCoord + IntVec2(0, -1), nextValue);
-					SetHeatIfLessAndNonSolid(isDirty, distField, tileCoord + IntVec2(1, 0), nextValue);
-					SetHeatIfLessAndNonSolid(isDirty, distField, tileCoord + IntVec2(-1, 0), nextValue);
-					SetHeatIfLessAndNonSolid(isDirty, distField, tileCoord + IntVec2(1, -1), nextValue);
-					SetHeatIfLessAndNonSolid(isDirty, distField, tileCoord + IntVec2(-1, 1), nextValue);
-				}
-			}
-		}
-		currentValue += 1.f;
-	}
-
-	for (int tileY = 0; tileY < m_mapDef->m_gridSize.y; ++tileY)
-	{
-		for (int tileX = 0; tileX < m_mapDef->m_gridSize.x; ++tileX)
-		{
-			IntVec2 tileCoord = IntVec2(tileX, tileY);
-			if (distField.GetHeatAt(tileCoord) == maxCost)
-			{
-				distField.SetHeatAt(tileCoord, -1.f);
-			}
-		}
+		heat[tileIndex] = (float)m_moveCosts[tileIndex];
 	}
 }
 
-void Map::SetHeatIfLessAndNonSolid(bool& isDirty, TileHeatMap& distField, IntVec2 coords, float value) const
+bool Map::IsTileWalkable(IntVec2 coord) const
 {
-	if (!IsTileInWorldBounds(coords.x, coords.y))
+	if (coord.x < 0 || coord.y < 0 || coord.x >= m_mapDef->m_gridSize.x || coord.y >= m_mapDef->m_gridSize.y)
 	{
-		return;
-	}
-	if (GetTile(GetTileIndex(coords.x, coords.y))->m_type == 0)
-	{
-		return;
-	}
-	if (distField.GetHeatAt(coords) < value)
-	{
-		return;
+		return false;
 	}
+	return (m_mapDef->m_tiles.m_flags[GetTileIndex(coord.x, coord.y)] & TILE_FLAGS_NOT_WALKABLE) == 0;
+}
 
-	distField.SetHeatAt(coords, value);
-	isDirty = true;
+int Map::GetTileMoveCost(int tileIndex, UnitDefinitions const* unitDef) const
+{
+	return ::GetTileMoveCost(m_mapDef->m_tiles.m_flags[tileIndex], unitDef);
 }
 
 void Map::LoadMapDef(MapDefinition* mapDef)
 {
 	DeleteGridData();
 
+	// LoadMap can run on a live map. The old fields are keyed by Unit pointers the push_backs below may move
+	delete m_reachabilityCache;
+	m_reachabilityCache = nullptr;
+	delete m_heatMap;
+	m_heatMap = nullptr;
+	m_isHeatMapCurrent = false;
+
 	m_mapDef = mapDef;
+	m_rng = RandomNumberGenerator();
 
 	m_overlayShader = g_theRenderer->CreateShader(mapDef->m_overlayShader.c_str());
 
+	std::fill(mapDef->m_tiles.m_occupants.begin(), mapDef->m_tiles.m_occupants.end(), NO_TILE_OCCUPANT);
+
 	for (int col = 0; col < mapDef->m_gridSize.y; col++)
 	{
 		for (int row = 0; row < mapDef->m_gridSize.x; row++)
 		{
-			if (!IsTileInWorldBounds(row, col))
+			int tileIndex = GetTileIndex(row, col);
+			if ((mapDef->m_tiles.m_flags[tileIndex] & TILE_FLAG_OUT_OF_BOUNDS) != 0)
 			{
 				continue;
 			}
 
-			Tile* tile = mapDef->m_tiles[GetTileIndex(row, col)];
-			if (tile->m_type == 0)
+			if (IsTileBlocked(tileIndex))
 			{
 				AddVertForZHexagon(m_GridVertexes, m_GridIndexes, Vec3(GetTileWorldPosition(row, col), 0.0f), HEX_RADIUS, Rgba8::COLOR_BLACK);
 			}
-			else if (tile->m_type == 1)
+			else
 			{
 				AddVertForZHexagonOutline(m_GridVertexes, m_GridIndexes, Vec3(GetTileWorldPosition(row, col), 0.0f), HEX_RADIUS, Rgba8::COLOR_WHITE, 0.05f);
 			}
@@ -433,28 +207,48 @@ void Map::LoadMapDef(MapDefinition* mapDef)
 
 	for (int i = 0; i < m_mapDef->m_units.size(); i++)
 	{
-		m_units.push_back(*m_mapDef->m_units[i]);
+		UnitPlacement const& placement = m_mapDef->m_units[i];
+		m_units.push_back(Unit(placement.m_unitDef, placement.m_playerID, placement.m_coord));
 	}
 
+	GUARANTEE_OR_DIE(m_units.size() < 0x7fff, "Too many units for the tile grid occupants");
 	for (int i = 0; i < m_units.size(); i++)
 	{
 		m_units[i].LoadDataFromMap(this);
 		IntVec2 coord = m_units[i].m_currentCoord;
-		Tile* tile = GetTile(GetTileIndex(coord.x, coord.y));
-		tile->m_currentUnit = &m_units[i];
+		SetTileUnit(GetTileIndex(coord.x, coord.y), &m_units[i]);
+	}
+
+	m_walkableBits.Resize(m_mapDef->m_gridSize);
+	for (int tileIndex = 0; tileIndex < (int)m_mapDef->m_tiles.m_flags.size(); tileIndex++)
+	{
+		if ((m_mapDef->m_tiles.m_flags[tileIndex] & TILE_FLAGS_NOT_WALKABLE) == 0)
+		{
+			m_walkableBits.Set(GetTileCoord(tileIndex));
+		}
 	}
+	m_rangeLayers.clear();
+
+	int maxAttackRange = 0;
+	for (size_t i = 0; i < UnitDefinitions::s_unitDefs.size(); i++)
+	{
+		maxAttackRange = IntMax(maxAttackRange, UnitDefinitions::s_unitDefs[i]->m_groundAttackRangeMax);
+	}
+	m_attackRings.Build(maxAttackRange);
+	m_lineOfSight.Invalidate(m_mapDef, &m_attackRings);
 
 	m_heatMap = new TileHeatMap(m_mapDef->m_gridSize);
+	m_reachabilityCache = new ReachabilityCache(this);
 
 	InitPlayers();
 }
 
 void Map::ResetUnitsData()
 {
-	for (int i = 0; i < m_mapDef->m_tiles.size(); i++)
-	{
-		m_mapDef->m_tiles[i]->m_currentUnit = nullptr;
-	}
+	m_reachabilityCache->Clear();
+	m_rangeLayers.clear();
+	m_isHeatMapCurrent = false;
+	std::fill(m_mapDef->m_tiles.m_occupants.begin(), m_mapDef->m_tiles.m_occupants.end(), NO_TILE_OCCUPANT);
 	for (int i = 0; i < m_mapDef->m_units.size(); i++)
 	{
 		m_units[i].SetData(m_mapDef->m_units[i]);
@@ -476,204 +270,333 @@ IntVec2 Map::GetTileCoord(int index) const
 
 Vec2 Map::GetTileWorldPosition(int x, int y) const
 {
-	return Vec2(x * 0.866f, 0.5f * x + y);
+	return GetHexWorldPosition(IntVec2(x, y));
 }
 
-bool Map::IsTileInWorldBounds(int x, int y) const
+IntVec2 Map::GetTileCoordAtWorldPosition(Vec2 worldPos) const
 {
-	FloatRange xRange = FloatRange(m_mapDef->m_worldBoundsMin.x, m_mapDef->m_worldBoundsMax.x);
-	FloatRange yRange = FloatRange(m_mapDef->m_worldBoundsMin.y, m_mapDef->m_worldBoundsMax.y);
-
-	Vec2 worldPos = GetTileWorldPosition(x, y);
+	return GetHexCoordAtWorldPosition(worldPos);
+}
 
-	return xRange.IsOnRange(worldPos.x) && yRange.IsOnRange(worldPos.y);
+bool Map::IsTileInWorldBounds(int x, int y) const
+{
+	return m_mapDef->IsTileInWorldBounds(IntVec2(x, y));
 }
 
 bool Map::IsTileInInRangeCurrentHeatMap(int x, int y, int rangeMax, int rangeMin) const
 {
+	// While every move costs 1 the step layers answer anything they reach out to, only further queries or
+	// weighted terrain need the full distance field
+	if (rangeMax >= 0 && rangeMax < (int)m_rangeLayers.size() && rangeMin <= rangeMax)
+	{
+		IntVec2 coord(x, y);
+		return m_rangeLayers[rangeMax].IsSet(coord) && (rangeMin <= 0 || !m_rangeLayers[rangeMin - 1].IsSet(coord));
+	}
+
+	if (!m_isHeatMapCurrent && m_currentSelectedUnit)
+	{
+		*m_heatMap = m_reachabilityCache->GetField(m_currentSelectedUnit);
+		m_isHeatMapCurrent = true;
+	}
 	int value = (int)m_heatMap->GetHeatAt(IntVec2(x, y));
 
 	return value <= rangeMax && value >= rangeMin;
 }
 
+void Map::PopulateRangeLayers(Unit const* unit)
+{
+	m_isHeatMapCurrent = false;
+	if (GetMaxTileMoveCost(unit->m_unitDef) != 1)
+	{
+		// Steps aren't move costs on this terrain, the heat map answers instead
+		m_rangeLayers.clear();
+		return;
+	}
+
+	// Every step costs the same, so whole rows of tiles can be grown a step at a time instead of walking a BFS
+	HexBitGrid::PopulateStepLayers(m_rangeLayers, unit->m_currentCoord, unit->m_unitDef->m_movementRange, m_walkableBits);
+}
+
+bool Map::IsTileInAttackRange(UnitDefinitions const* unitDef, IntVec2 fromCoord, IntVec2 targetCoord) const
+{
+	return ::IsTileInAttackRange(*m_mapDef, m_attackRings, m_lineOfSight, unitDef, fromCoord, targetCoord);
+}
+
+bool Map::HasLineOfSight(IntVec2 fromCoord, IntVec2 toCoord) const
+{
+	int offsetIndex = m_attackRings.GetOffsetIndex(toCoord - fromCoord);
+	if (offsetIndex < 0)
+	{
+		return LineOfSightCache::TraceLineOfSight(m_mapDef, fromCoord, toCoord);
+	}
+	return m_lineOfSight.HasLineOfSight(GetTileIndex(fromCoord.x, fromCoord.y), offsetIndex);
+}
+
+void Map::GetAttackableUnits(Unit const* attacker, IntVec2 fromCoord, std::vector<Unit*>& out_targets) const
+{
+	out_targets.clear();
+	m_attackOccupants.clear();
+	GetOccupantsInAttackRange(m_attackOccupants, *m_mapDef, m_mapDef->m_tiles.m_occupants, m_attackRings, m_lineOfSight, attacker->m_unitDef, fromCoord);
+	for (size_t i = 0; i < m_attackOccupants.size(); i++)
+	{
+		Unit* target = const_cast<Unit*>(&m_units[m_attackOccupants[i]]);
+		if (!target->m_isDead && target->m_playerID != attacker->m_playerID)
+		{
+			out_targets.push_back(target);
+		}
+	}
+}
+
 void Map::SetCurrentCamera(Camera* camera)
 {
 	m_camera = camera;
 }
 
-Tile* Map::GetTile(int index) const
+unsigned int Map::GetTileType(int index) const
+{
+	return m_mapDef->m_tiles.m_flags[index] & TILE_TYPE_MASK;
+}
+
+bool Map::IsTileBlocked(int index) const
+{
+	return (m_mapDef->m_tiles.m_flags[index] & TILE_FLAG_BLOCKED) != 0;
+}
+
+Unit* Map::GetTileUnit(int index) const
+{
+	short occupant = m_mapDef->m_tiles.m_occupants[index];
+	if (occupant == NO_TILE_OCCUPANT)
+	{
+		return nullptr;
+	}
+	return const_cast<Unit*>(&m_units[occupant]);
+}
+
+Unit* Map::GetTileUnit(IntVec2 coord) const
 {
-	return m_mapDef->m_tiles[index];
+	return GetTileUnit(GetTileIndex(coord.x, coord.y));
 }
 
-Tile* Map::GetTile(IntVec2 coord) const
+void Map::SetTileUnit(int index, Unit* unit)
 {
-	return GetTile(GetTileIndex(coord.x, coord.y));
+	m_mapDef->m_tiles.m_occupants[index] = unit ? (short)(unit - m_units.data()) : NO_TILE_OCCUPANT;
 }
 
 std::vector<IntVec2> Map::GetShortestPathToCoord(IntVec2 start, IntVec2 end) const
 {
 	std::vector<IntVec2> result;
-	float startHeat = m_heatMap->GetHeatAt(start);
-	float endHeat = m_heatMap->GetHeatAt(end);
-	int range = (int)(endHeat - startHeat);
-
-	IntVec2 evalutedCoord = end;
-	result.push_back(evalutedCoord);
-
-	for (size_t i = 0; i < range; i++)
-	{
-		IntVec2 neighborCoords[6];
-		neighborCoords[0] = evalutedCoord + IntVec2(0, 1);
-		neighborCoords[1] = evalutedCoord + IntVec2(0, -1);
-		neighborCoords[2] = evalutedCoord + IntVec2(1, 0);
-		neighborCoords[3] = evalutedCoord + IntVec2(-1, 0);
-		neighborCoords[4] = evalutedCoord + IntVec2(1, -1);
-		neighborCoords[5] = evalutedCoord + IntVec2(-1, 1);
-
-		float neighborHeat[6];
-		neighborHeat[0] = m_heatMap->GetHeatAt(neighborCoords[0]);
-		neighborHeat[1] = m_heatMap->GetHeatAt(neighborCoords[1]);
-		neighborHeat[2] = m_heatMap->GetHeatAt(neighborCoords[2]);
-		neighborHeat[3] = m_heatMap->GetHeatAt(neighborCoords[3]);
-		neighborHeat[4] = m_heatMap->GetHeatAt(neighborCoords[4]);
-		neighborHeat[5] = m_heatMap->GetHeatAt(neighborCoords[5]);
-
-		float lowestHeat = m_heatMap->GetHeatAt(evalutedCoord);
-		IntVec2 lowestHeatCoords;
-		for (int j = 0; j < 6; j++)
+	if (start == end)
+	{
+		result.push_back(end);
+		return result;
+	}
+	if (!IsTileWalkable(end))
+	{
+		return result;
+	}
+
+	int gridSizeX = m_mapDef->m_gridSize.x;
+	int gridSizeY = m_mapDef->m_gridSize.y;
+	int numTiles = gridSizeX * gridSizeY;
+
+	PathSearchScratch& scratch = m_pathScratch;
+	if ((int)scratch.m_tileGenerations.size() != numTiles)
+	{
+		scratch.m_costSoFar.resize(numTiles);
+		scratch.m_cameFrom.resize(numTiles);
+		scratch.m_tileGenerations.assign(numTiles, 0);
+		scratch.m_generation = 0;
+	}
+	scratch.m_generation++;
+	if (scratch.m_generation == 0)
+	{
+		// Wrapped around, old stamps could look current again
+		std::fill(scratch.m_tileGenerations.begin(), scratch.m_tileGenerations.end(), 0);
+		scratch.m_generation = 1;
+	}
+
+	// Lowest estimate on top, ties go to the node furthest along so the search runs straight at the goal
+	auto isWorseNode = [](PathOpenNode const& a, PathOpenNode const& b)
+	{
+		if (a.m_estimatedTotalCost != b.m_estimatedTotalCost)
+		{
+			return a.m_estimatedTotalCost > b.m_estimatedTotalCost;
+		}
+		return a.m_costSoFar < b.m_costSoFar;
+	};
+
+	int startIndex = GetTileIndex(start.x, start.y);
+	int endIndex = GetTileIndex(end.x, end.y);
+	Unit const* mover = GetTileUnit(startIndex);
+	UnitDefinitions const* moverDef = mover ? mover->m_unitDef : nullptr;
+	std::vector<unsigned char> const& tileFlags = m_mapDef->m_tiles.m_flags;
+
+	// Every step costs at least the cheapest tile, so hex distance times that never overestimates
+	float heuristicScale = (float)GetMinTileMoveCost(moverDef);
+	scratch.m_costSoFar[startIndex] = 0.f;
+	scratch.m_cameFrom[startIndex] = -1;
+	scratch.m_tileGenerations[startIndex] = scratch.m_generation;
+
+	std::vector<PathOpenNode>& openList = scratch.m_openList;
+	openList.clear();
+	openList.push_back(PathOpenNode{ heuristicScale * (float)GetHexDistance(start, end), 0.f, startIndex });
+
+	bool isEndReached = false;
+	while (!openList.empty())
+	{
+		std::pop_heap(openList.begin(), openList.end(), isWorseNode);
+		PathOpenNode current = openList.back();
+		openList.pop_back();
+
+		if (current.m_tileIndex == endIndex)
+		{
+			isEndReached = true;
+			break;
+		}
+		if (current.m_costSoFar > scratch.m_costSoFar[current.m_tileIndex])
+		{
+			continue;
+		}
+
+		IntVec2 tileCoord = GetTileCoord(current.m_tileIndex);
+		for (int neighbor = 0; neighbor < NUM_HEX_NEIGHBORS; neighbor++)
 		{
-			if (!IsTileInWorldBounds(neighborCoords[j].x, neighborCoords[j].y))
+			IntVec2 neighborCoord = tileCoord + HEX_NEIGHBOR_OFFSETS[neighbor];
+			if (neighborCoord.x < 0 || neighborCoord.y < 0 || neighborCoord.x >= gridSizeX || neighborCoord.y >= gridSizeY)
 			{
 				continue;
 			}
-			if (GetTile(neighborCoords[j])->m_type == 0 || m_heatMap->GetHeatAt(neighborCoords[j]) == -1.f)
+
+			int neighborIndex = neighborCoord.y * gridSizeX + neighborCoord.x;
+			if ((tileFlags[neighborIndex] & TILE_FLAGS_NOT_WALKABLE) != 0)
 			{
-				neighborHeat[j] = 9999.f;
+				continue;
 			}
-			if (neighborHeat[j] < lowestHeat)
+			float costSoFar = current.m_costSoFar + (float)GetTileMoveCost(neighborIndex, moverDef);
+			if (scratch.m_tileGenerations[neighborIndex] == scratch.m_generation && scratch.m_costSoFar[neighborIndex] <= costSoFar)
 			{
-				lowestHeatCoords = neighborCoords[j];
+				continue;
 			}
+
+			scratch.m_tileGenerations[neighborIndex] = scratch.m_generation;
+			scratch.m_costSoFar[neighborIndex] = costSoFar;
+			scratch.m_cameFrom[neighborIndex] = current.m_tileIndex;
+			openList.push_back(PathOpenNode{ costSoFar + heuristicScale * (float)GetHexDistance(neighborCoord, end), costSoFar, neighborIndex });
+			std::push_heap(openList.begin(), openList.end(), isWorseNode);
 		}
-		result.push_back(lowestHeatCoords);
-		evalutedCoord = lowestHeatCoords;
 	}
 
+	if (!isEndReached)
+	{
+		return result;
+	}
+
+	for (int tileIndex = endIndex; tileIndex != -1; tileIndex = scratch.m_cameFrom[tileIndex])
+	{
+		result.push_back(GetTileCoord(tileIndex));
+	}
 	return result;
 }
 
 void Map::ShowUI(int row, int col)
 {
-	Tile* tile = GetTile(IntVec2(row, col));
+	Unit* tileUnit = GetTileUnit(IntVec2(row, col));
 
-	if (IsPointInsideZHexagon3D(m_raycastVsPlane.m_impactPos, Vec3(GetTileWorldPosition(row, col), 0.0f), HEX_RADIUS))
+	if (tileUnit)
 	{
-		if (tile->m_currentUnit)
+		if (m_currentSelectedUnit)
 		{
-			if (m_currentSelectedUnit)
-			{
-				ReadDataUnit(tile->m_currentUnit, m_currentSelectedUnit->m_playerID);
-			}
-			else
-			{
-				ReadDataUnit(tile->m_currentUnit);
-			}
-
-			if (tile->m_currentUnit->m_playerID == 1)
-			{
-				m_game->m_p1TankInfoPanel->SetActive(true);
-			}
-			else if (tile->m_currentUnit->m_playerID == 2)
-			{
-				m_game->m_p2TankInfoPanel->SetActive(true);
-			}
-
-			if (tile->m_currentUnit->m_playerID == m_currentPlayerIDTurn && !tile->m_currentUnit->m_isDoneForThisTurn)
-			{
-				m_game->m_LMBSprite->SetActive(true);
-			}
+			ReadDataUnit(tileUnit, m_currentSelectedUnit->m_playerID);
 		}
 		else
 		{
-			if (!m_currentSelectedUnit)
-			{
-				m_game->m_RMBSprite->SetActive(false);
-				m_game->m_LMBSprite->SetActive(false);
-
-				m_game->m_YSprite->SetActive(true);
-			}
+			ReadDataUnit(tileUnit);
+		}
 
-			m_game->m_p1TankInfoPanel->SetActive(false);
-			m_game->m_p2TankInfoPanel->SetActive(false);
+		if (tileUnit->m_playerID == 1)
+		{
+			m_game->m_p1TankInfoPanel->SetActive(true);
+		}
+		else if (tileUnit->m_playerID == 2)
+		{
+			m_game->m_p2TankInfoPanel->SetActive(true);
 		}
 
-		if (m_currentSelectedUnit)
+		if (tileUnit->m_playerID == m_currentPlayerIDTurn && !tileUnit->m_isDoneForThisTurn)
+		{
+			m_game->m_LMBSprite->SetActive(true);
+		}
+	}
+	else
+	{
+		if (!m_currentSelectedUnit)
 		{
-			m_game->m_YSprite->SetActive(false);
+			m_game->m_RMBSprite->SetActive(false);
+			m_game->m_LMBSprite->SetActive(false);
 
-			if (m_currentSelectedUnit->m_playerID == 1)
-			{
-				m_game->m_p1TankInfoPanel->SetActive(true);
-			}
-			else if (m_currentSelectedUnit->m_playerID == 2)
-			{
-				m_game->m_p2TankInfoPanel->SetActive(true);
-			}
+			m_game->m_YSprite->SetActive(true);
+		}
 
-			m_game->m_LMBSprite->SetActive(true);
-			m_game->m_RMBSprite->SetActive(true);
+		m_game->m_p1TankInfoPanel->SetActive(false);
+		m_game->m_p2TankInfoPanel->SetActive(false);
+	}
 
-			if (!m_currentSelectedUnit->m_isMoved)
+	if (m_currentSelectedUnit)
+	{
+		m_game->m_YSprite->SetActive(false);
+
+		if (m_currentSelectedUnit->m_playerID == 1)
+		{
+			m_game->m_p1TankInfoPanel->SetActive(true);
+		}
+		else if (m_currentSelectedUnit->m_playerID == 2)
+		{
+			m_game->m_p2TankInfoPanel->SetActive(true);
+		}
+
+		m_game->m_LMBSprite->SetActive(true);
+		m_game->m_RMBSprite->SetActive(true);
+
+		if (!m_currentSelectedUnit->m_isMoved)
+		{
+			if (m_currentSelectedUnit->IsCoordInRangeOfMovement(IntVec2(row, col)))
 			{
-				if (m_currentSelectedUnit->IsCoordInRangeOfMovement(IntVec2(row, col)))
-				{
-					m_game->m_LMBText->SetText("Move");
+				m_game->m_LMBText->SetText("Move");
 
-					if (tile->m_currentUnit == m_currentSelectedUnit)
-					{
-						m_game->m_LMBText->SetText("Stay");
-					}
-				}
-				else
+				if (tileUnit == m_currentSelectedUnit)
 				{
-					m_game->m_LMBSprite->SetActive(false);
+					m_game->m_LMBText->SetText("Stay");
 				}
 			}
 			else
 			{
-				if (tile->m_currentUnit)
-				{
-					m_game->m_LMBSprite->SetActive(false);
-
-					if (m_currentSelectedUnit->IsUnitOfThatCoordInAttackRange(tile->m_currentUnit->m_currentCoord))
-					{
-						m_game->m_LMBSprite->SetActive(true);
-						m_game->m_LMBText->SetText("Fire");
-					}
+				m_game->m_LMBSprite->SetActive(false);
+			}
+		}
+		else
+		{
+			if (tileUnit)
+			{
+				m_game->m_LMBSprite->SetActive(false);
 
-					if (IntVec2(row, col) == m_currentSelectedUnit->m_currentCoord)
-					{
-						m_game->m_LMBSprite->SetActive(true);
-						m_game->m_LMBText->SetText("Hold Fire");
-					}
+				if (m_currentSelectedUnit->IsUnitOfThatCoordInAttackRange(tileUnit->m_currentCoord))
+				{
+					m_game->m_LMBSprite->SetActive(true);
+					m_game->m_LMBText->SetText("Fire");
 				}
-				else
+
+				if (IntVec2(row, col) == m_currentSelectedUnit->m_currentCoord)
 				{
-					m_game->m_LMBSprite->SetActive(false);
+					m_game->m_LMBSprite->SetActive(true);
+					m_game->m_LMBText->SetText("Hold Fire");
 				}
 			}
-
+			else
+			{
+				m_game->m_LMBSprite->SetActive(false);
+			}
 		}
-	}
 
-	if (!IsYourTurn())
-	{
-		m_game->m_RMBSprite->SetActive(false);
-		m_game->m_LMBSprite->SetActive(false);
-		m_game->m_YSprite->SetActive(false);
-		m_game->m_LeftSprite->SetActive(false);
-		m_game->m_RightSprite->SetActive(false);
 	}
 }
 
@@ -721,9 +644,7 @@ void Map::CurrentPlayerInput()
 					{
 						StartTurn();
 
-						EventArgs args;
-						args.SetValue("command", Stringf("\"StartTurn\""));
-						g_theNetwork->RemoteCommand(args);
+						SendGameMessage(GameMessage(GameMessageType::START_TURN));
 					}
 					if (g_theInput->WasKeyJustPressed(KEYCODE_RIGHT_MOUSE) || g_theInput->WasKeyJustPressed(KEYCODE_ESCAPE))
 					{
@@ -753,122 +674,90 @@ void Map::CurrentPlayerInput()
 	{
 		EndTurn();
 
-		EventArgs args;
-		args.SetValue("command", Stringf("\"EndTurn\""));
-		g_theNetwork->RemoteCommand(args);
+		SendGameMessage(GameMessage(GameMessageType::END_TURN));
 	}
 
 	if (IsYourTurn() && g_theInput->WasKeyJustPressed(KEYCODE_RIGHT_MOUSE))
 	{
 		Cancel();
 
-		EventArgs args;
-		args.SetValue("command", Stringf("\"Cancel\""));
-		g_theNetwork->RemoteCommand(args);
+		SendGameMessage(GameMessage(GameMessageType::CANCEL));
 	}
 
-	for (int col = 0; col < m_mapDef->m_gridSize.y; col++)
+	if (!IsYourTurn() || !m_isHoveringTile || !g_theInput->WasKeyJustPressed(KEYCODE_LEFT_MOUSE))
 	{
-		for (int row = 0; row < m_mapDef->m_gridSize.x; row++)
+		return;
+	}
+
+	int row = m_hoveredCoord.x;
+	int col = m_hoveredCoord.y;
+	Unit* tileUnit = GetTileUnit(m_hoveredCoord);
+
+	if (!m_currentSelectedUnit && tileUnit)
+	{
+		if (tileUnit->m_isDoneForThisTurn)
 		{
-			if (!IsTileInWorldBounds(row, col))
-			{
-				continue;
-			}
+			return;
+		}
+		if (tileUnit->m_playerID != m_currentPlayerIDTurn)
+		{
+			return;
+		}
 
-			Tile* tile = GetTile(GetTileIndex(row, col));
+		Select(IntVec2(row, col));
 
-			if (tile->m_type == 0)
-			{
-				continue;
-			}
+		SendGameMessage(GameMessage(GameMessageType::SELECT_FOCUSED_UNIT, IntVec2(row, col)));
+		return;
+	}
 
-			if (!IsYourTurn())
+	if (m_currentSelectedUnit)
+	{
+		if (m_currentSelectedUnit->m_playingMoveAnim || !m_currentSelectedUnit->m_isDoneRotating)
+		{
+			return;
+		}
+		if (m_currentSelectedUnit->m_isMoved)
+		{
+			if (tileUnit == m_currentSelectedUnit)
 			{
-				break;
+				HoldFire();
+
+				SendGameMessage(GameMessage(GameMessageType::HOLD_FIRE));
+				return;
 			}
 
-			if (g_theInput->WasKeyJustPressed(KEYCODE_LEFT_MOUSE))
+			if (tileUnit)
 			{
-				if (IsPointInsideZHexagon3D(m_raycastVsPlane.m_impactPos, Vec3(GetTileWorldPosition(row, col), 0.0f), HEX_RADIUS))
+				if (m_currentSelectedUnit->IsUnitOfThatCoordInAttackRange(IntVec2(row, col)))
 				{
-					if (!m_currentSelectedUnit && tile->m_currentUnit)
+					if (m_currentSelectedUnit->CanAttack())
 					{
-						if (tile->m_currentUnit->m_isDoneForThisTurn)
-						{
-							break;
-						}
-						if (tile->m_currentUnit->m_playerID != m_currentPlayerIDTurn)
-						{
-							break;
-						}
+						Attack(IntVec2(row, col));
 
-						Select(tile);
-
-						EventArgs args;
-						args.SetValue("command", Stringf("\"SelectFocusedUnit coords=%i,%i\"", row, col));
-						g_theNetwork->RemoteCommand(args);
-						break;
+						SendGameMessage(GameMessage(GameMessageType::ATTACK, IntVec2(row, col)));
 					}
 
-					if (m_currentSelectedUnit)
-					{
-						if (m_currentSelectedUnit->m_playingMoveAnim || !m_currentSelectedUnit->m_isDoneRotating)
-						{
-							break;
-						}
-						if (m_currentSelectedUnit->m_isMoved)
-						{
-							if (tile->m_currentUnit == m_currentSelectedUnit)
-							{
-								HoldFire();
-
-								EventArgs args;
-								args.SetValue("command", Stringf("\"HoldFire\""));
-								g_theNetwork->RemoteCommand(args);
-								break;
-							}
-
-							if (tile->m_currentUnit)
-							{
-								if (m_currentSelectedUnit->IsUnitOfThatCoordInAttackRange(IntVec2(row, col)))
-								{
-									if (m_currentSelectedUnit->CanAttack())
-									{
-										Attack(tile);
-
-										EventArgs args;
-										args.SetValue("command", Stringf("\"Attack coords=%i,%i\"", row, col));
-										g_theNetwork->RemoteCommand(args);
-									}
-
-									break;
-								}
-							}
-							else
-							{
-								break;
-							}
-						}
-						else
-						{
-							if (tile->m_currentUnit && tile->m_currentUnit != m_currentSelectedUnit)
-							{
-								break;
-							}
-
-							Move(IntVec2(row, col));
-
-							EventArgs args;
-							args.SetValue("command", Stringf("\"Move coords=%i,%i\"", row, col));
-							g_theNetwork->RemoteCommand(args);
-						}
-
-						break;
-					}
+					return;
 				}
 			}
+			else
+			{
+				return;
+			}
 		}
+		else
+		{
+			if (tileUnit && tileUnit != m_currentSelectedUnit)
+			{
+				return;
+			}
+
+			Move(IntVec2(row, col));
+
+			SendGameMessage(GameMessage(GameMessageType::MOVE, IntVec2(row, col)));
+		}
+
+		return;
 	}
 }
 
@@ -940,9 +829,14 @@ void Map::HoldFire()
 	m_game->m_LMBSprite->SetActive(false);
 }
 
-void Map::Attack(Tile* tile)
+void Map::Attack(IntVec2 coord)
 {
-	m_currentSelectedUnit->Attack(tile);
+	Unit* target = GetTileUnit(coord);
+	if (!m_currentSelectedUnit || !target || target->m_playerID == m_currentSelectedUnit->m_playerID)
+	{
+		return;
+	}
+	m_currentSelectedUnit->Attack(coord);
 	m_currentSelectedUnit->m_isDoneForThisTurn = true;
 	m_currentSelectedUnit->m_isSelected = false;
 	m_currentSelectedUnit = nullptr;
@@ -953,18 +847,27 @@ void Map::Attack(Tile* tile)
 
 void Map::Move(IntVec2 coord)
 {
+	if (!m_currentSelectedUnit)
+	{
+		return;
+	}
 	m_game->m_RMBText->SetText("Cancel");
 	m_currentSelectedUnit->Play_MoveAnimation(coord);
 	m_currentSelectedUnit->MoveUnit(coord);
-	PopulateDistanceField(*m_heatMap, m_currentSelectedUnit->m_currentCoord, 9999.f);
+	PopulateRangeLayers(m_currentSelectedUnit);
 }
 
-void Map::Select(Tile* tile)
+void Map::Select(IntVec2 coord)
 {
-	m_currentSelectedUnit = tile->m_currentUnit;
+	Unit* unit = GetTileUnit(coord);
+	if (!unit)
+	{
+		return;
+	}
+	m_currentSelectedUnit = unit;
 	m_currentSelectedUnit->m_previousOrientation = m_currentSelectedUnit->m_model->m_orientation;
 	m_currentSelectedUnit->m_isSelected = true;
-	PopulateDistanceField(*m_heatMap, m_currentSelectedUnit->m_currentCoord, 9999.f);
+	PopulateRangeLayers(m_currentSelectedUnit);
 }
 
 void Map::ReadDataUnit(Unit* unit, int lock_id)
@@ -1103,9 +1006,7 @@ void Map::GameEnd()
 	m_game->m_dialoguePanel->SetActive(false);
 	SetPlayerQuit(GetApplicationPlayerID());
 
-	EventArgs args;
-	args.SetValue("command", Stringf("\"PlayerQuit id=%i\"", GetApplicationPlayerID()));
-	g_theNetwork->RemoteCommand(args);
+	SendGameMessage(GameMessage(GameMessageType::PLAYER_QUIT, GetApplicationPlayerID()));
 }
 
 void Map::InitPlayers()
@@ -1143,7 +1044,7 @@ void Map::InitPlayers()
 void Map::RenderHover() const
 {
 	Vec3 selectPos(GetTileWorldPosition(m_currentFocusedCoord.x, m_currentFocusedCoord.y), 0.0f);
-	Tile* tile = GetTile(m_currentFocusedCoord);
+	Unit* focusedUnit = GetTileUnit(m_currentFocusedCoord);
 	std::vector<Vertex_PCU> selectVertexes;
 	std::vector<unsigned int> selectIndexes;
 
@@ -1157,7 +1058,7 @@ void Map::RenderHover() const
 			AddVertForZHexagonOutline(selectVertexes, selectIndexes, pathPos, HEX_RADIUS, Rgba8::COLOR_YELLOW, 0.1f);
 		}
 	}
-	if (tile->m_currentUnit && tile->m_currentUnit->m_playerID != m_currentPlayerIDTurn)
+	if (focusedUnit && focusedUnit->m_playerID != m_currentPlayerIDTurn)
 	{
 		AddVertForZHexagonOutline(selectVertexes, selectIndexes, selectPos, HEX_RADIUS * 0.8f, Rgba8::COLOR_RED, 0.07f);
 	}
@@ -1168,32 +1069,17 @@ void Map::RenderHover() const
 
 	if (!IsYourTurn())
 	{
-		for (int col = 0; col < m_mapDef->m_gridSize.y; col++)
+		if (m_isHoveringTile)
 		{
-			for (int row = 0; row < m_mapDef->m_gridSize.x; row++)
+			Vec3 yourSelectPos(GetTileWorldPosition(m_hoveredCoord.x, m_hoveredCoord.y), 0.0f);
+			Unit* yourTileUnit = GetTileUnit(m_hoveredCoord);
+			if (yourTileUnit && yourTileUnit->m_playerID != GetApplicationPlayerID())
 			{
-				if (!IsTileInWorldBounds(row, col))
-				{
-					continue;
-				}
-				Vec3 yourSelectPos(GetTileWorldPosition(row, col), 0.0f);
-
-				Tile* yourTile = GetTile(IntVec2(row, col));
-				if (yourTile->m_type == 0)
-				{
-					continue;
-				}
-				if (IsPointInsideZHexagon3D(m_raycastVsPlane.m_impactPos, yourSelectPos, HEX_RADIUS))
-				{
-					if (yourTile->m_currentUnit && yourTile->m_currentUnit->m_playerID != GetApplicationPlayerID())
-					{
-						AddVertForZHexagonOutline(selectVertexes, selectIndexes, yourSelectPos, HEX_RADIUS * 0.8f, Rgba8::COLOR_DARK_RED, 0.07f);
-					}
-					else
-					{
-						AddVertForZHexagonOutline(selectVertexes, selectIndexes, yourSelectPos, HEX_RADIUS * 0.8f, Rgba8::COLOR_DARK_GREEN, 0.07f);
-					}
-				}
+				AddVertForZHexagonOutline(selectVertexes, selectIndexes, yourSelectPos, HEX_RADIUS * 0.8f, Rgba8::COLOR_DARK_RED, 0.07f);
+			}
+			else
+			{
+				AddVertForZHexagonOutline(selectVertexes, selectIndexes, yourSelectPos, HEX_RADIUS * 0.8f, Rgba8::COLOR_DARK_GREEN, 0.07f);
 			}
 		}
 	}
@@ -1217,32 +1103,33 @@ void Map::RenderCurrentUnitInformation() const
 		std::vector<Vertex_PCU> rangeVerts;
 		std::vector<unsigned int>  rangeIndexes;
 
-		for (int col = 0; col < m_mapDef->m_gridSize.y; col++)
+		if (m_currentSelectedUnit->m_isMoved)
 		{
-			for (int row = 0; row < m_mapDef->m_gridSize.x; row++)
+			if (m_currentSelectedUnit->CanAttack() && !m_currentSelectedUnit->m_isDead)
 			{
-				if (!IsTileInWorldBounds(row, col))
+				std::vector<Unit*> targets;
+				GetAttackableUnits(m_currentSelectedUnit, m_currentSelectedUnit->m_currentCoord, targets);
+				for (size_t i = 0; i < targets.size(); i++)
 				{
-					continue;
+					IntVec2 coord = targets[i]->m_currentCoord;
+					Vec3 worldPos(GetTileWorldPosition(coord.x, coord.y), 0.0f);
+					AddVertForZHexagon(rangeVerts, rangeIndexes, worldPos, HEX_RADIUS * 0.8f, Rgba8::COLOR_DARK_RED);
 				}
-				if (m_currentSelectedUnit->m_isMoved)
+			}
+		}
+		else
+		{
+			for (int col = 0; col < m_mapDef->m_gridSize.y; col++)
+			{
+				for (int row = 0; row < m_mapDef->m_gridSize.x; row++)
 				{
-					if (m_currentSelectedUnit->IsUnitOfThatCoordInAttackRange(IntVec2(row, col)) && m_currentSelectedUnit->CanAttack())
+					if (!IsTileInWorldBounds(row, col))
 					{
-						Tile* tile = m_mapDef->m_tiles[GetTileIndex(row, col)];
-						if (tile->m_type == 1)
-						{
-							Vec3 worldPos(GetTileWorldPosition(row, col), 0.0f);
-							AddVertForZHexagon(rangeVerts, rangeIndexes, worldPos, HEX_RADIUS * 0.8f, Rgba8::COLOR_DARK_RED);
-						}
+						continue;
 					}
-				}
-				else
-				{
 					if (IsTileInInRangeCurrentHeatMap(row, col, m_currentSelectedUnit->m_unitDef->m_movementRange))
 					{
-						Tile* tile = m_mapDef->m_tiles[GetTileIndex(row, col)];
-						if (tile->m_type == 1)
+						if (!IsTileBlocked(GetTileIndex(row, col)))
 						{
 							Vec3 worldPos(GetTileWorldPosition(row, col), 0.0f);
 							AddVertForZHexagon(rangeVerts, rangeIndexes, worldPos, HEX_RADIUS, Rgba8(255, 255, 255, 100));
@@ -1250,7 +1137,6 @@ void Map::RenderCurrentUnitInformation() const
 						}
 					}
 				}
-
 			}
 		}
 		g_theRenderer->DrawIndexedBuffer(rangeVerts, rangeIndexes);
@@ -1274,8 +1160,7 @@ void Map::RenderDebug() const
 			{
 				if (!IsTileInWorldBounds(row, col))
 				{
-					Tile* tile = m_mapDef->m_tiles[GetTileIndex(row, col)];
-					if (tile->m_type == 1)
+					if (!IsTileBlocked(GetTileIndex(row, col)))
 					{
 						AddVertForZHexagonOutline(outerGridVertexes, outerGridIndexes, Vec3(GetTileWorldPosition(row, col), 0.0f), HEX_RADIUS, Rgba8::COLOR_VIOLET, 0.025f);
 					}
@@ -1352,35 +1237,28 @@ void Map::RaycastUpdate()
 		}
 	}
 
-	for (int col = 0; col < m_mapDef->m_gridSize.y; col++)
+	// Only the hex under the cursor gets picked and gets UI, whatever the size of the map
+	m_hoveredCoord = GetTileCoordAtWorldPosition(Vec2(m_raycastVsPlane.m_impactPos.x, m_raycastVsPlane.m_impactPos.y));
+	m_isHoveringTile = IsTileWalkable(m_hoveredCoord);
+	if (m_isHoveringTile)
 	{
-		for (int row = 0; row < m_mapDef->m_gridSize.x; row++)
+		if (IsYourTurn())
 		{
-			if (!IsTileInWorldBounds(row, col))
-			{
-				continue;
-			}
-			Vec3 selectPos(GetTileWorldPosition(row, col), 0.0f);
-
-			Tile* tile = GetTile(IntVec2(row, col));
-			if (tile->m_type == 0)
-			{
-				continue;
-			}
+			m_currentFocusedCoord = m_hoveredCoord;
+			// State, not an action: the network only sends it when the hex changed, at most at its state rate
+			SendGameMessage(GameMessage(GameMessageType::SET_FOCUSED_HEX, m_hoveredCoord));
+		}
 
-			if (IsYourTurn())
-			{
-				if (IsPointInsideZHexagon3D(m_raycastVsPlane.m_impactPos, selectPos, HEX_RADIUS))
-				{
-					m_currentFocusedCoord = IntVec2(row, col);
-					EventArgs args;
-					args.SetValue("command", Stringf("\"SetFocusedHex coords=%i,%i\"", row, col));
-					g_theNetwork->RemoteCommand(args);
-				}
-			}
+		ShowUI(m_hoveredCoord.x, m_hoveredCoord.y);
+	}
 
-			ShowUI(row, col);
-		}
+	if (!IsYourTurn())
+	{
+		m_game->m_RMBSprite->SetActive(false);
+		m_game->m_LMBSprite->SetActive(false);
+		m_game->m_YSprite->SetActive(false);
+		m_game->m_LeftSprite->SetActive(false);
+		m_game->m_RightSprite->SetActive(false);
 	}
 }
 
@@ -1,57 +1,32 @@
 #pragma once
 #include "Game/GameCommon.hpp"
+#include "Game/GameDefinitions.hpp"
+#include "Game/HexBitGrid.hpp"
+#include "Game/HexRangeTable.hpp"
 
 constexpr float HEX_RADIUS = 0.5f;
 
-class Tile;
 class Unit;
 class TileHeatMap;
 class Player;
+class ReachabilityCache;
 
-struct TileDefinition
+struct PathOpenNode
 {
-	char m_symbol = ' ';
-	std::string m_name = " ";
-	bool m_isBlocked = false;
-
-public:
-	TileDefinition(XmlElement& element);
-	static void InitializeTileDefs(char const* filePath);
-	static void ClearDefinition();
-	static TileDefinition* GetBySymbol(char symbol);
-	static unsigned int GetType(TileDefinition* tileDef);
-	static std::vector<TileDefinition*> s_tileDefs;
+	float m_estimatedTotalCost = 0.f;
+	float m_costSoFar = 0.f;
+	int m_tileIndex = 0;
 };
 
-
-struct MapDefinition
+// Per-tile state of the last path search, kept between searches so they don't allocate.
+// A tile's entries only count when its generation matches m_generation, so nothing is cleared per search
+struct PathSearchScratch
 {
-	std::string m_name = " ";
-	std::string m_overlayShader = " ";
-	IntVec2 m_gridSize;
-	Vec3 m_worldBoundsMin;
-	Vec3 m_worldBoundsMax;
-
-	std::vector<Tile*> m_tiles;
-	std::vector<Unit*> m_units;
-
-public:
-	MapDefinition(XmlElement& element);
-	void SetUpTiles(XmlElement* element);
-	void SetUpUnits(XmlElement* element);
-	static void InitializeMapDefs(char const* filePath);
-	static void ClearDefinition();
-	static MapDefinition* GetByName(std::string const& name);
-	static std::vector<MapDefinition*> s_mapDefs;
-};
-
-class Tile
-{
-public:
-	Tile(TileDefinition* tileDef);
-	Tile(unsigned int type);
-	unsigned int m_type;
-	Unit* m_currentUnit = nullptr;
+	std::vector<float> m_costSoFar;
+	std::vector<int> m_cameFrom;
+	std::vector<unsigned int> m_tileGenerations;
+	std::vector<PathOpenNode> m_openList;
+	unsigned int m_generation = 0;
 };
 
 class Map
@@ -66,8 +41,11 @@ public:
 	void Shutdown();
 	void DeleteGridData();
 
-	void PopulateDistanceField(TileHeatMap& out_distanceField, IntVec2 startCoords, float maxCost) const;
-	void SetHeatIfLessAndNonSolid(bool& isDirty, TileHeatMap& distField, IntVec2 coords, float value) const;
+	// Cost from startCoords to every tile, -1 where it is blocked, unreachable or maxCost away or further.
+	// The shared PopulateMoveCosts with the move costs of the unit at startCoords when useTileCosts is set
+	void PopulateDistanceField(TileHeatMap& out_distanceField, IntVec2 startCoords, float maxCost, bool useTileCosts = false) const;
+	bool IsTileWalkable(IntVec2 coord) const;
+	int GetTileMoveCost(int tileIndex, UnitDefinitions const* unitDef) const;	// Cost of stepping onto the tile, tile defaults when unitDef is null
 
 	void LoadMapDef(MapDefinition* mapDef);
 
@@ -76,13 +54,25 @@ public:
 	int GetTileIndex(int x, int y) const;
 	IntVec2 GetTileCoord(int index) const;
 	Vec2 GetTileWorldPosition(int x, int y) const;
+	IntVec2 GetTileCoordAtWorldPosition(Vec2 worldPos) const;	// The hex containing worldPos, may be off the grid
 	bool IsTileInWorldBounds(int x, int y) const;
-	bool IsTileInInRangeCurrentHeatMap(int x, int y, int rangeMax, int rangeMin = 0) const;
+	bool IsTileInInRangeCurrentHeatMap(int x, int y, int rangeMax, int rangeMin = 0) const;	// Move cost from the selected unit
+	void PopulateRangeLayers(Unit const* unit);	// Step layers out to the unit's movement, none when its move costs differ
+	// Straight hex distance from fromCoord within the unit's attack range, whatever lies between unless it needs line of sight
+	bool IsTileInAttackRange(UnitDefinitions const* unitDef, IntVec2 fromCoord, IntVec2 targetCoord) const;
+	bool HasLineOfSight(IntVec2 fromCoord, IntVec2 toCoord) const;	// No blocked tile strictly between the two
+	// Living enemies of the unit it could hit standing on fromCoord, found from m_attackRings without a grid walk
+	void GetAttackableUnits(Unit const* attacker, IntVec2 fromCoord, std::vector<Unit*>& out_targets) const;
 
 	void SetCurrentCamera(Camera* camera);
 
-	Tile* GetTile(int index) const;
-	Tile* GetTile(IntVec2 coord) const;
+	unsigned int GetTileType(int index) const;
+	bool IsTileBlocked(int index) const;
+	Unit* GetTileUnit(int index) const;
+	Unit* GetTileUnit(IntVec2 coord) const;
+	void SetTileUnit(int index, Unit* unit);	// nullptr empties the tile
+	// A* from start to end, returned end first and start last; empty when end can't be reached.
+	// Doesn't need a distance field, the search stops as soon as end is settled
 	std::vector<IntVec2> GetShortestPathToCoord(IntVec2 start, IntVec2 end) const;
 	
 	void ShowUI(int row, int col);
@@ -92,9 +82,9 @@ public:
 	void EndTurn();
 	void StartTurn();
 	void HoldFire();
-	void Attack(Tile* tile);
+	void Attack(IntVec2 coord);
 	void Move(IntVec2 coord);
-	void Select(Tile* tile);
+	void Select(IntVec2 coord);
 
 	void ReadDataUnit(Unit* unit, int lock_id = 0);
 
@@ -126,6 +116,13 @@ public:
 	Player* m_player2 = nullptr;
 
 	TileHeatMap* m_heatMap = nullptr;
+	mutable bool m_isHeatMapCurrent = false;	// Filled from m_reachabilityCache only once a range query needs it
+	std::vector<HexBitGrid> m_rangeLayers;	// Tiles within n steps of the selected unit, in front of m_heatMap
+	HexBitGrid m_walkableBits;
+	HexRingTable m_attackRings;	// Out to the longest attack of any unit definition
+	mutable LineOfSightCache m_lineOfSight;
+	RandomNumberGenerator m_rng;	// This match's presentation rolls, restarted by LoadMapDef so a replay looks the same
+	ReachabilityCache* m_reachabilityCache = nullptr;
 	MapDefinition* m_mapDef = nullptr;
 	Game* m_game = nullptr;
 	Camera* m_camera = nullptr;
@@ -151,10 +148,17 @@ public:
 	VertexBuffer* m_GridVertexBuffer;
 	IndexBuffer* m_GridIndexBuffer;
 
+	mutable PathSearchScratch m_pathScratch;
+	mutable MoveCostScratch m_moveScratch;
+	mutable std::vector<int> m_moveCosts;	// PopulateDistanceField's whole costs before they go in the heat map
+	mutable std::vector<int> m_attackOccupants;
+
 	RaycastResult3D m_raycastVsPlane;
 	bool m_debugDraw = false;
 
 	IntVec2 m_currentFocusedCoord;
+	IntVec2 m_hoveredCoord;
+	bool m_isHoveringTile = false;	// Cursor is over a walkable tile this frame
 	Unit* m_currentSelectedUnit = nullptr;
 	int m_currentPlayerIDTurn = 1;
 	bool m_isPendingEndTurn = false;
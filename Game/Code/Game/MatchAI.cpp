@@ -0,0 +1,120 @@
+#include "Game/MatchAI.hpp"
+#include <limits.h>
+#include <stdlib.h>
+
+constexpr int AI_SHOT_SCORE = 1000;
+constexpr int AI_KILL_SCORE = 500;
+
+void MatchAI::PlayTurn(MatchSimulation& match)
+{
+	for (int unitIndex = 0; unitIndex < (int)match.m_units.size() && !match.IsMatchOver(); unitIndex++)
+	{
+		MatchUnit const& unit = match.m_units[unitIndex];
+		if (unit.m_playerID == match.m_currentPlayerID && !unit.m_isDead && !unit.m_isDone)
+		{
+			PlayUnit(match, unitIndex);
+		}
+	}
+}
+
+void MatchAI::PlayUnit(MatchSimulation& match, int unitIndex)
+{
+	MatchUnit const& unit = match.m_units[unitIndex];
+	int idealDistance = unit.m_unitDef->m_groundAttackRangeMax;
+
+	int bestTileIndex = match.GetTileIndex(unit.m_coord);
+	int bestTarget = -1;
+	int bestScore = INT_MIN;
+	int numBestTiles = 0;
+
+	match.PopulateMoveCosts(unitIndex, m_moveCosts);
+	for (int tileIndex = 0; tileIndex < (int)m_moveCosts.size(); tileIndex++)
+	{
+		if (m_moveCosts[tileIndex] < 0)
+		{
+			continue;
+		}
+		short occupant = match.m_occupants[tileIndex];
+		if (occupant != NO_TILE_OCCUPANT && occupant != unitIndex)
+		{
+			continue;
+		}
+
+		IntVec2 coord = match.GetTileCoord(tileIndex);
+		int score = -abs(GetNearestEnemyDistance(match, unitIndex, coord) - idealDistance);
+		int target = -1;
+		if (match.CanAttackFrom(unitIndex, coord))
+		{
+			int targetScore = 0;
+			target = GetBestTarget(match, unitIndex, coord, targetScore);
+			score += targetScore;
+		}
+
+		// Reservoir pick among equal scores, each tied tile ends up chosen with the same chance
+		if (score > bestScore)
+		{
+			numBestTiles = 0;
+		}
+		if (score >= bestScore && match.m_rng.RollRandomIntLessThan(++numBestTiles) == 0)
+		{
+			bestScore = score;
+			bestTileIndex = tileIndex;
+			bestTarget = target;
+		}
+	}
+
+	match.Move(unitIndex, match.GetTileCoord(bestTileIndex));
+	if (bestTarget == -1 || !match.Attack(unitIndex, match.m_units[bestTarget].m_coord))
+	{
+		match.HoldFire(unitIndex);
+	}
+}
+
+int MatchAI::GetBestTarget(MatchSimulation& match, int unitIndex, IntVec2 fromCoord, int& out_score)
+{
+	int attackDamage = match.m_units[unitIndex].m_unitDef->m_groundAttackDamage;
+	int bestTarget = -1;
+	int numBestTargets = 0;
+	out_score = 0;
+
+	match.GetAttackableUnits(unitIndex, fromCoord, m_targets);
+	for (size_t i = 0; i < m_targets.size(); i++)
+	{
+		MatchUnit const& target = match.m_units[m_targets[i]];
+		int damage = target.m_unitDef->GetDamageTaken(attackDamage);
+		int healthLeft = target.m_health - damage;
+		int score = AI_SHOT_SCORE + damage - ((healthLeft > 0) ? healthLeft : -AI_KILL_SCORE);
+		if (score > out_score)
+		{
+			numBestTargets = 0;
+		}
+		if (score >= out_score && match.m_rng.RollRandomIntLessThan(++numBestTargets) == 0)
+		{
+			out_score = score;
+			bestTarget = m_targets[i];
+		}
+	}
+	return bestTarget;
+}
+
+int MatchAI::GetNearestEnemyDistance(MatchSimulation const& match, int unitIndex, IntVec2 coord) const
+{
+	int playerID = match.m_units[unitIndex].m_playerID;
+	int nearestDistance = 0;
+	bool isAnyEnemyLeft = false;
+	for (size_t i = 0; i < match.m_units.size(); i++)
+	{
+		MatchUnit const& other = match.m_units[i];
+		if (other.m_isDead || other.m_playerID == playerID)
+		{
+			continue;
+		}
+		int distance = GetHexDistance(coord, other.m_coord);
+		if (!isAnyEnemyLeft || distance < nearestDistance)
+		{
+			nearestDistance = distance;
+			isAnyEnemyLeft = true;
+		}
+	}
+	return nearestDistance;
+}
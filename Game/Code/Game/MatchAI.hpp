@@ -0,0 +1,19 @@
+#pragma once
+#include "Game/MatchSimulation.hpp"
+
+// Scripted player for headless matches. Each unit in turn takes the best shot it can line up this turn, preferring
+// kills and then the most damage, or moves to stand at its longest range from the nearest enemy when it has no shot.
+// Ties are broken with the match's m_rng, so the same seed always plays out the same match
+class MatchAI
+{
+public:
+	void PlayTurn(MatchSimulation& match);
+
+private:
+	void PlayUnit(MatchSimulation& match, int unitIndex);
+	int GetBestTarget(MatchSimulation& match, int unitIndex, IntVec2 fromCoord, int& out_score);
+	int GetNearestEnemyDistance(MatchSimulation const& match, int unitIndex, IntVec2 coord) const;
+
+	std::vector<int> m_moveCosts;
+	std::vector<int> m_targets;
+};
@@ -0,0 +1,167 @@
+#include "Game/MatchBatch.hpp"
+#include "Game/MatchAI.hpp"
+#include "Engine/Core/JobSystem.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include "ThirdParty/SquirrelNoise/RawNoise.hpp"
+
+constexpr unsigned int FNV_OFFSET_BASIS = 2166136261u;
+constexpr unsigned int FNV_PRIME = 16777619u;
+
+// What one thread needs to play matches, built the first time the thread claims some
+struct MatchBatchWorker
+{
+	MatchSimulation* m_match = nullptr;
+	MatchAI m_players[2];
+	std::vector<UnitTypeStats> m_unitTypeStats;
+};
+
+static void AddToDigest(unsigned int& digest, unsigned int value)
+{
+	digest = (digest ^ value) * FNV_PRIME;
+}
+
+static void AddEventToDigest(unsigned int& digest, MatchEvent const& event)
+{
+	AddToDigest(digest, (unsigned int)event.m_type);
+	AddToDigest(digest, (unsigned int)event.m_unitIndex);
+	AddToDigest(digest, (unsigned int)event.m_targetIndex);
+	AddToDigest(digest, (unsigned int)event.m_playerID);
+	AddToDigest(digest, (unsigned int)event.m_amount);
+	AddToDigest(digest, (unsigned int)event.m_fromCoord.x);
+	AddToDigest(digest, (unsigned int)event.m_fromCoord.y);
+	AddToDigest(digest, (unsigned int)event.m_toCoord.x);
+	AddToDigest(digest, (unsigned int)event.m_toCoord.y);
+}
+
+static void AddEventToStats(MatchEvent const& event, std::vector<int> const& unitTypeIndexes, std::vector<UnitTypeStats>& stats)
+{
+	switch (event.m_type)
+	{
+	case MatchEventType::UNIT_FIRED:
+		stats[unitTypeIndexes[event.m_unitIndex]].m_numShots++;
+		break;
+	case MatchEventType::UNIT_DAMAGED:
+		stats[unitTypeIndexes[event.m_unitIndex]].m_damageDealt += event.m_amount;
+		stats[unitTypeIndexes[event.m_targetIndex]].m_damageTaken += event.m_amount;
+		break;
+	case MatchEventType::UNIT_DESTROYED:
+		stats[unitTypeIndexes[event.m_unitIndex]].m_numKills++;
+		break;
+	default:
+		break;
+	}
+}
+
+static void PlayMatch(MatchBatchSettings const& settings, int matchIndex, std::vector<int> const& unitTypeIndexes, MatchBatchWorker& worker, MatchResult& out_result)
+{
+	MatchSimulation& match = *worker.m_match;
+	match.Reset(GetMatchSeed(settings.m_seed, matchIndex));
+
+	unsigned int digest = FNV_OFFSET_BASIS;
+	while (!match.IsMatchOver() && match.m_turnNumber <= settings.m_maxTurns)
+	{
+		worker.m_players[match.m_currentPlayerID - 1].PlayTurn(match);
+		match.EndTurn();
+
+		for (MatchEvent const& event : match.m_events)
+		{
+			AddEventToDigest(digest, event);
+			AddEventToStats(event, unitTypeIndexes, worker.m_unitTypeStats);
+		}
+		match.m_events.clear();
+	}
+
+	for (size_t unitIndex = 0; unitIndex < match.m_units.size(); unitIndex++)
+	{
+		UnitTypeStats& stats = worker.m_unitTypeStats[unitTypeIndexes[unitIndex]];
+		stats.m_numFielded++;
+		if (!match.m_units[unitIndex].m_isDead)
+		{
+			stats.m_numSurvived++;
+		}
+	}
+
+	out_result.m_winnerPlayerID = match.m_winnerPlayerID;
+	// A won match ends partway through its last turn, a drawn one has already moved on to the turn past the limit
+	out_result.m_numTurns = match.IsMatchOver() ? match.m_turnNumber : match.m_turnNumber - 1;
+	out_result.m_eventDigest = digest;
+}
+
+unsigned int GetMatchSeed(unsigned int batchSeed, int matchIndex)
+{
+	return Get1dNoiseUint(matchIndex, batchSeed);
+}
+
+void RunMatchBatch(MatchBatchSettings const& settings, MatchBatchResults& out_results, JobSystem* jobSystem)
+{
+	GUARANTEE_OR_DIE(settings.m_mapDef, "Match batch has no map");
+
+	// Unit type of each of the map's units, in the order MatchSimulation::Reset lays out m_units
+	std::vector<UnitPlacement> const& placements = settings.m_mapDef->m_units;
+	std::vector<int> unitTypeIndexes(placements.size(), 0);
+	for (size_t unitIndex = 0; unitIndex < placements.size(); unitIndex++)
+	{
+		for (size_t typeIndex = 0; typeIndex < UnitDefinitions::s_unitDefs.size(); typeIndex++)
+		{
+			if (UnitDefinitions::s_unitDefs[typeIndex] == placements[unitIndex].m_unitDef)
+			{
+				unitTypeIndexes[unitIndex] = (int)typeIndex;
+			}
+		}
+	}
+
+	out_results = MatchBatchResults();
+	out_results.m_matches.resize(settings.m_numMatches);
+
+	// Each thread plays whole matches into their own result slots and sums stats only into its own worker, so
+	// nothing below depends on which thread played which match
+	MatchBatchWorker workers[MAX_PARALLEL_FOR_PARTICIPANTS];
+	auto playMatches = [&](int matchBegin, int matchEnd, int participantIndex)
+	{
+		MatchBatchWorker& worker = workers[participantIndex];
+		if (!worker.m_match)
+		{
+			worker.m_match = new MatchSimulation(settings.m_mapDef);
+			worker.m_unitTypeStats.resize(UnitDefinitions::s_unitDefs.size());
+		}
+		for (int matchIndex = matchBegin; matchIndex < matchEnd; matchIndex++)
+		{
+			PlayMatch(settings, matchIndex, unitTypeIndexes, worker, out_results.m_matches[matchIndex]);
+		}
+	};
+
+	if (jobSystem)
+	{
+		jobSystem->ParallelForParticipants(0, settings.m_numMatches, settings.m_grainSize, playMatches);
+	}
+	else
+	{
+		playMatches(0, settings.m_numMatches, 0);
+	}
+
+	out_results.m_unitTypeStats.resize(UnitDefinitions::s_unitDefs.size());
+	for (MatchBatchWorker& worker : workers)
+	{
+		for (size_t typeIndex = 0; typeIndex < worker.m_unitTypeStats.size(); typeIndex++)
+		{
+			UnitTypeStats const& from = worker.m_unitTypeStats[typeIndex];
+			UnitTypeStats& to = out_results.m_unitTypeStats[typeIndex];
+			to.m_numFielded += from.m_numFielded;
+			to.m_numSurvived += from.m_numSurvived;
+			to.m_numShots += from.m_numShots;
+			to.m_numKills += from.m_numKills;
+			to.m_damageDealt += from.m_damageDealt;
+			to.m_damageTaken += from.m_damageTaken;
+		}
+		delete worker.m_match;
+		worker.m_match = nullptr;
+	}
+
+	out_results.m_eventDigest = FNV_OFFSET_BASIS;
+	for (MatchResult const& result : out_results.m_matches)
+	{
+		out_results.m_numWins[result.m_winnerPlayerID]++;
+		out_results.m_totalTurns += result.m_numTurns;
+		AddToDigest(out_results.m_eventDigest, result.m_eventDigest);
+	}
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include "Game/MatchSimulation.hpp"
+
+class JobSystem;
+
+// One UnitDefinitions' totals over a batch, both players together
+struct UnitTypeStats
+{
+	int m_numFielded = 0;
+	int m_numSurvived = 0;	// Still alive when its match ended
+	int m_numShots = 0;
+	int m_numKills = 0;
+	int m_damageDealt = 0;
+	int m_damageTaken = 0;
+};
+
+struct MatchResult
+{
+	int m_winnerPlayerID = 0;	// 0 when the match hit the turn limit
+	int m_numTurns = 0;	// Turns played, m_maxTurns for a draw
+	unsigned int m_eventDigest = 0;	// FNV-1a over the match's events, changes with any change to the rules or the AI
+};
+
+struct MatchBatchSettings
+{
+	MapDefinition const* m_mapDef = nullptr;
+	int m_numMatches = 1;
+	unsigned int m_seed = 0;	// Match i plays from GetMatchSeed(m_seed, i), whichever thread runs it
+	int m_maxTurns = 200;		// Called a draw past this, two cautious players can circle forever
+	int m_grainSize = 4;		// Matches a thread claims at a time
+};
+
+struct MatchBatchResults
+{
+	std::vector<MatchResult> m_matches;			// By match index
+	std::vector<UnitTypeStats> m_unitTypeStats;	// By index into UnitDefinitions::s_unitDefs
+	int m_numWins[3] = {};	// Draws, then by player ID
+	int m_totalTurns = 0;
+	unsigned int m_eventDigest = 0;	// The match digests folded in match order, the same for any thread count
+};
+
+unsigned int GetMatchSeed(unsigned int batchSeed, int matchIndex);
+
+// Plays MatchAI against MatchAI settings.m_numMatches times, spread over jobSystem's workers and the calling thread,
+// or only the calling thread without one
+void RunMatchBatch(MatchBatchSettings const& settings, MatchBatchResults& out_results, JobSystem* jobSystem = nullptr);
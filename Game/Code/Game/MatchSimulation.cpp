@@ -0,0 +1,291 @@
+#include "Game/MatchSimulation.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+
+MatchSimulation::MatchSimulation(MapDefinition const* mapDef)
+	:m_mapDef(mapDef)
+{
+	int maxAttackRange = 0;
+	for (size_t i = 0; i < UnitDefinitions::s_unitDefs.size(); i++)
+	{
+		if (UnitDefinitions::s_unitDefs[i]->m_groundAttackRangeMax > maxAttackRange)
+		{
+			maxAttackRange = UnitDefinitions::s_unitDefs[i]->m_groundAttackRangeMax;
+		}
+	}
+	m_attackRings.Build(maxAttackRange);
+	m_lineOfSight.Invalidate(m_mapDef, &m_attackRings);
+
+	Reset();
+}
+
+void MatchSimulation::Reset(unsigned int seed)
+{
+	GUARANTEE_OR_DIE(m_mapDef->m_units.size() < 0x7fff, "Too many units for the tile grid occupants");
+
+	m_units.clear();
+	m_occupants.assign(m_mapDef->m_tiles.m_flags.size(), NO_TILE_OCCUPANT);
+	for (size_t i = 0; i < m_mapDef->m_units.size(); i++)
+	{
+		UnitPlacement const& placement = m_mapDef->m_units[i];
+		MatchUnit unit;
+		unit.m_unitDef = placement.m_unitDef;
+		unit.m_playerID = placement.m_playerID;
+		unit.m_coord = placement.m_coord;
+		unit.m_turnStartCoord = placement.m_coord;
+		unit.m_health = placement.m_unitDef->m_health;
+		m_units.push_back(unit);
+		m_occupants[GetTileIndex(placement.m_coord)] = (short)i;
+	}
+
+	m_currentPlayerID = 1;
+	m_turnNumber = 1;
+	m_winnerPlayerID = 0;
+	m_events.clear();
+	m_rng = RandomNumberGenerator(seed);
+}
+
+bool MatchSimulation::Move(int unitIndex, IntVec2 coord)
+{
+	if (!CanTakeOrder(unitIndex) || m_units[unitIndex].m_hasMoved)
+	{
+		return false;
+	}
+	if (coord.x < 0 || coord.y < 0 || coord.x >= m_mapDef->m_gridSize.x || coord.y >= m_mapDef->m_gridSize.y)
+	{
+		return false;
+	}
+
+	int occupant = GetUnitAt(coord);
+	if (occupant != -1 && occupant != unitIndex)
+	{
+		return false;
+	}
+
+	std::vector<int> moveCosts;
+	PopulateMoveCosts(unitIndex, moveCosts);
+	if (moveCosts[GetTileIndex(coord)] < 0)
+	{
+		return false;
+	}
+
+	MatchUnit& unit = m_units[unitIndex];
+	m_occupants[GetTileIndex(unit.m_coord)] = NO_TILE_OCCUPANT;
+	m_occupants[GetTileIndex(coord)] = (short)unitIndex;
+	unit.m_turnStartCoord = unit.m_coord;
+	unit.m_coord = coord;
+	unit.m_hasMoved = true;
+
+	MatchEvent moved;
+	moved.m_type = MatchEventType::UNIT_MOVED;
+	moved.m_unitIndex = unitIndex;
+	moved.m_playerID = unit.m_playerID;
+	moved.m_fromCoord = unit.m_turnStartCoord;
+	moved.m_toCoord = coord;
+	m_events.push_back(moved);
+	return true;
+}
+
+bool MatchSimulation::Attack(int unitIndex, IntVec2 targetCoord)
+{
+	if (!CanTakeOrder(unitIndex) || !m_units[unitIndex].m_hasMoved)
+	{
+		return false;
+	}
+
+	MatchUnit& unit = m_units[unitIndex];
+	int targetIndex = GetUnitAt(targetCoord);
+	if (targetIndex == -1 || m_units[targetIndex].m_playerID == unit.m_playerID)
+	{
+		return false;
+	}
+	if (!CanAttackFrom(unitIndex, unit.m_coord) || !IsTileInAttackRange(unitIndex, unit.m_coord, targetCoord))
+	{
+		return false;
+	}
+
+	MatchEvent fired;
+	fired.m_type = MatchEventType::UNIT_FIRED;
+	fired.m_unitIndex = unitIndex;
+	fired.m_targetIndex = targetIndex;
+	fired.m_playerID = unit.m_playerID;
+	fired.m_fromCoord = unit.m_coord;
+	fired.m_toCoord = targetCoord;
+	m_events.push_back(fired);
+
+	MatchUnit& target = m_units[targetIndex];
+	int damage = target.m_unitDef->GetDamageTaken(unit.m_unitDef->m_groundAttackDamage);
+	target.m_health -= damage;
+
+	MatchEvent damaged = fired;
+	damaged.m_type = MatchEventType::UNIT_DAMAGED;
+	damaged.m_amount = damage;
+	m_events.push_back(damaged);
+
+	if (target.m_health <= 0)
+	{
+		target.m_isDead = true;
+		m_occupants[GetTileIndex(targetCoord)] = NO_TILE_OCCUPANT;
+
+		MatchEvent destroyed = fired;
+		destroyed.m_type = MatchEventType::UNIT_DESTROYED;
+		m_events.push_back(destroyed);
+	}
+
+	unit.m_isDone = true;
+	MatchEvent done;
+	done.m_type = MatchEventType::UNIT_DONE;
+	done.m_unitIndex = unitIndex;
+	done.m_playerID = unit.m_playerID;
+	m_events.push_back(done);
+
+	CheckForWinner();
+	return true;
+}
+
+bool MatchSimulation::HoldFire(int unitIndex)
+{
+	if (!CanTakeOrder(unitIndex) || !m_units[unitIndex].m_hasMoved)
+	{
+		return false;
+	}
+
+	m_units[unitIndex].m_isDone = true;
+	MatchEvent done;
+	done.m_type = MatchEventType::UNIT_DONE;
+	done.m_unitIndex = unitIndex;
+	done.m_playerID = m_units[unitIndex].m_playerID;
+	m_events.push_back(done);
+	return true;
+}
+
+void MatchSimulation::EndTurn()
+{
+	if (IsMatchOver())
+	{
+		return;
+	}
+
+	for (int unitIndex = 0; unitIndex < (int)m_units.size(); unitIndex++)
+	{
+		MatchUnit const& unit = m_units[unitIndex];
+		if (unit.m_playerID == m_currentPlayerID && unit.m_hasMoved && !unit.m_isDone && !unit.m_isDead)
+		{
+			HoldFire(unitIndex);
+		}
+	}
+
+	for (size_t i = 0; i < m_units.size(); i++)
+	{
+		m_units[i].m_hasMoved = false;
+		m_units[i].m_isDone = false;
+	}
+	m_currentPlayerID = (m_currentPlayerID == 1) ? 2 : 1;
+	m_turnNumber++;
+
+	MatchEvent started;
+	started.m_type = MatchEventType::TURN_STARTED;
+	started.m_playerID = m_currentPlayerID;
+	m_events.push_back(started);
+}
+
+void MatchSimulation::PopulateMoveCosts(int unitIndex, std::vector<int>& out_costs) const
+{
+	MatchUnit const& unit = m_units[unitIndex];
+	::PopulateMoveCosts(out_costs, *m_mapDef, unit.m_coord, unit.m_unitDef, true, unit.m_unitDef->m_movementRange + 1, m_moveScratch);
+}
+
+bool MatchSimulation::IsTileInAttackRange(int unitIndex, IntVec2 fromCoord, IntVec2 targetCoord) const
+{
+	return ::IsTileInAttackRange(*m_mapDef, m_attackRings, m_lineOfSight, m_units[unitIndex].m_unitDef, fromCoord, targetCoord);
+}
+
+void MatchSimulation::GetAttackableUnits(int unitIndex, IntVec2 fromCoord, std::vector<int>& out_targets) const
+{
+	out_targets.clear();
+	MatchUnit const& unit = m_units[unitIndex];
+	GetOccupantsInAttackRange(out_targets, *m_mapDef, m_occupants, m_attackRings, m_lineOfSight, unit.m_unitDef, fromCoord);
+
+	// The dead are off the grid already, only the unit's own side needs dropping
+	size_t numTargets = 0;
+	for (size_t i = 0; i < out_targets.size(); i++)
+	{
+		if (m_units[out_targets[i]].m_playerID != unit.m_playerID)
+		{
+			out_targets[numTargets++] = out_targets[i];
+		}
+	}
+	out_targets.resize(numTargets);
+}
+
+bool MatchSimulation::CanAttackFrom(int unitIndex, IntVec2 fromCoord) const
+{
+	MatchUnit const& unit = m_units[unitIndex];
+	IntVec2 turnStartCoord = unit.m_hasMoved ? unit.m_turnStartCoord : unit.m_coord;
+	return unit.m_unitDef->CanAttack(fromCoord != turnStartCoord);
+}
+
+int MatchSimulation::GetTileIndex(IntVec2 coord) const
+{
+	return coord.y * m_mapDef->m_gridSize.x + coord.x;
+}
+
+IntVec2 MatchSimulation::GetTileCoord(int tileIndex) const
+{
+	return IntVec2(tileIndex % m_mapDef->m_gridSize.x, tileIndex / m_mapDef->m_gridSize.x);
+}
+
+int MatchSimulation::GetUnitAt(IntVec2 coord) const
+{
+	if (coord.x < 0 || coord.y < 0 || coord.x >= m_mapDef->m_gridSize.x || coord.y >= m_mapDef->m_gridSize.y)
+	{
+		return -1;
+	}
+	return m_occupants[GetTileIndex(coord)];
+}
+
+bool MatchSimulation::IsMatchOver() const
+{
+	return m_winnerPlayerID != 0;
+}
+
+bool MatchSimulation::CanTakeOrder(int unitIndex) const
+{
+	if (IsMatchOver() || unitIndex < 0 || unitIndex >= (int)m_units.size())
+	{
+		return false;
+	}
+	MatchUnit const& unit = m_units[unitIndex];
+	return !unit.m_isDead && !unit.m_isDone && unit.m_playerID == m_currentPlayerID;
+}
+
+void MatchSimulation::CheckForWinner()
+{
+	bool doesPlayer1HaveUnits = false;
+	bool doesPlayer2HaveUnits = false;
+	for (size_t i = 0; i < m_units.size(); i++)
+	{
+		if (!m_units[i].m_isDead)
+		{
+			doesPlayer1HaveUnits |= (m_units[i].m_playerID == 1);
+			doesPlayer2HaveUnits |= (m_units[i].m_playerID == 2);
+		}
+	}
+
+	if (!doesPlayer1HaveUnits)
+	{
+		m_winnerPlayerID = 2;
+	}
+	else if (!doesPlayer2HaveUnits)
+	{
+		m_winnerPlayerID = 1;
+	}
+	else
+	{
+		return;
+	}
+
+	MatchEvent ended;
+	ended.m_type = MatchEventType::MATCH_ENDED;
+	ended.m_playerID = m_winnerPlayerID;
+	m_events.push_back(ended);
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include "Game/GameDefinitions.hpp"
+#include "Game/HexRangeTable.hpp"
+#include "Engine/Math/RandomNumberGenerator.hpp"
+
+enum class MatchEventType
+{
+	UNIT_MOVED,		// m_unitIndex from m_fromCoord to m_toCoord, the two match when it stayed put
+	UNIT_FIRED,		// m_unitIndex at m_targetIndex
+	UNIT_DAMAGED,	// m_targetIndex lost m_amount health
+	UNIT_DESTROYED,	// m_targetIndex
+	UNIT_DONE,		// m_unitIndex has nothing left to do this turn
+	TURN_STARTED,	// m_playerID is up
+	MATCH_ENDED,	// m_playerID won
+	NUM_MATCH_EVENT_TYPES
+};
+
+struct MatchEvent
+{
+	MatchEventType m_type = MatchEventType::UNIT_MOVED;
+	int m_unitIndex = -1;
+	int m_targetIndex = -1;
+	int m_playerID = 0;
+	int m_amount = 0;
+	IntVec2 m_fromCoord;
+	IntVec2 m_toCoord;
+};
+
+struct MatchUnit
+{
+	UnitDefinitions const* m_unitDef = nullptr;
+	int m_playerID = 0;
+	IntVec2 m_coord;
+	IntVec2 m_turnStartCoord;
+	int m_health = 0;
+	bool m_hasMoved = false;	// Moved or stayed put this turn, next is an attack or holding fire
+	bool m_isDone = false;
+	bool m_isDead = false;
+};
+
+// A match played by the same rules as Map and Unit, on plain data and without a window, renderer, audio or UI,
+// so matches can run headless by the thousand. Orders that change anything append MatchEvents for whatever
+// presents the match; nothing here draws or plays a sound. Players that need chance draw from m_rng, so a match
+// replays the same from the same seed on any thread
+class MatchSimulation
+{
+public:
+	explicit MatchSimulation(MapDefinition const* mapDef);
+
+	void Reset(unsigned int seed = 0);	// Units back where the map places them, player 1 to move, no events
+
+	// Orders for the unit's player on their turn, taken in the game's order: a move, onto its own tile to stay
+	// put, then an attack or holding fire. False, with nothing changed, when the rules don't allow the order
+	bool Move(int unitIndex, IntVec2 coord);
+	bool Attack(int unitIndex, IntVec2 targetCoord);
+	bool HoldFire(int unitIndex);
+	void EndTurn();	// Units that moved without attacking hold fire
+
+	// Move cost from where the unit stands to every tile, -1 where it can't get to this turn. The same
+	// PopulateMoveCosts Map::PopulateDistanceField uses, cut off at the unit's movement range
+	void PopulateMoveCosts(int unitIndex, std::vector<int>& out_costs) const;
+	bool IsTileInAttackRange(int unitIndex, IntVec2 fromCoord, IntVec2 targetCoord) const;
+	void GetAttackableUnits(int unitIndex, IntVec2 fromCoord, std::vector<int>& out_targets) const;
+	bool CanAttackFrom(int unitIndex, IntVec2 fromCoord) const;	// Whether the unit's type lets it fire after moving there
+
+	int GetTileIndex(IntVec2 coord) const;
+	IntVec2 GetTileCoord(int tileIndex) const;
+	int GetUnitAt(IntVec2 coord) const;	// -1 for an empty tile or off the grid
+	bool IsMatchOver() const;
+
+public:
+	MapDefinition const* m_mapDef = nullptr;
+	std::vector<MatchUnit> m_units;
+	std::vector<short> m_occupants;	// Per tile, an index into m_units or NO_TILE_OCCUPANT
+	int m_currentPlayerID = 1;
+	int m_turnNumber = 1;
+	int m_winnerPlayerID = 0;	// Set once one player has no units left
+	std::vector<MatchEvent> m_events;	// Appended by the orders, cleared by whoever reads them
+	RandomNumberGenerator m_rng;	// This match's stream, restarted at position 0 by Reset
+
+private:
+	bool CanTakeOrder(int unitIndex) const;
+	void CheckForWinner();
+
+	HexRingTable m_attackRings;
+	mutable LineOfSightCache m_lineOfSight;
+	mutable MoveCostScratch m_moveScratch;
+};
@@ -0,0 +1,92 @@
+#include "Game/ReachabilityCache.hpp"
+#include "Game/Map.hpp"
+#include "Game/Unit.hpp"
+
+ReachabilityField::ReachabilityField(Unit const* unit, IntVec2 origin, IntVec2 gridSize)
+	:m_unit(unit)
+	,m_origin(origin)
+	,m_distances(gridSize)
+{
+}
+
+ReachabilityCache::ReachabilityCache(Map const* map)
+	:m_map(map)
+{
+}
+
+ReachabilityCache::~ReachabilityCache()
+{
+	Clear();
+}
+
+TileHeatMap const& ReachabilityCache::GetField(Unit const* unit)
+{
+	m_useCounter++;
+
+	ReachabilityField* oldestField = nullptr;
+	int numUnitFields = 0;
+	for (size_t i = 0; i < m_fields.size(); i++)
+	{
+		ReachabilityField* field = m_fields[i];
+		if (field->m_unit != unit)
+		{
+			continue;
+		}
+		if (field->m_origin == unit->m_currentCoord)
+		{
+			field->m_lastUsed = m_useCounter;
+			m_numFieldsReused++;
+			return field->m_distances;
+		}
+
+		numUnitFields++;
+		if (!oldestField || field->m_lastUsed < oldestField->m_lastUsed)
+		{
+			oldestField = field;
+		}
+	}
+
+	ReachabilityField* field = nullptr;
+	if (numUnitFields >= MAX_CACHED_ORIGINS_PER_UNIT)
+	{
+		field = oldestField;
+		field->m_origin = unit->m_currentCoord;
+	}
+	else
+	{
+		field = new ReachabilityField(unit, unit->m_currentCoord, m_map->m_mapDef->m_gridSize);
+		m_fields.push_back(field);
+	}
+
+	m_map->PopulateDistanceField(field->m_distances, field->m_origin, REACHABILITY_MAX_COST, true);
+	field->m_lastUsed = m_useCounter;
+	m_numFieldsBuilt++;
+	return field->m_distances;
+}
+
+void ReachabilityCache::OnUnitDied(Unit const* unit)
+{
+	for (size_t i = 0; i < m_fields.size();)
+	{
+		ReachabilityField* field = m_fields[i];
+		if (field->m_unit != unit)
+		{
+			i++;
+			continue;
+		}
+
+		delete field;
+		m_fields[i] = m_fields.back();
+		m_fields.pop_back();
+	}
+}
+
+void ReachabilityCache::Clear()
+{
+	for (size_t i = 0; i < m_fields.size(); i++)
+	{
+		delete m_fields[i];
+		m_fields[i] = nullptr;
+	}
+	m_fields.clear();
+}
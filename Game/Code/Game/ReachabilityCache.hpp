@@ -0,0 +1,41 @@
+#pragma once
+#include "Game/GameCommon.hpp"
+
+class Map;
+class Unit;
+
+constexpr float REACHABILITY_MAX_COST = 9999.f;
+constexpr int MAX_CACHED_ORIGINS_PER_UNIT = 2;	// Where the unit stands and where it came from, so Cancel finds its old field
+
+struct ReachabilityField
+{
+	ReachabilityField(Unit const* unit, IntVec2 origin, IntVec2 gridSize);
+
+	Unit const* m_unit = nullptr;
+	IntVec2 m_origin;
+	TileHeatMap m_distances;
+	unsigned int m_lastUsed = 0;
+};
+
+// Distance fields per unit and origin, the same values Map::PopulateDistanceField gives for the unit standing there.
+// A field only depends on the terrain and the unit's move costs, never on where other units stand, so one stays
+// valid for as long as the unit lives and hovering, selecting and cancelling keep reusing it
+class ReachabilityCache
+{
+public:
+	ReachabilityCache(Map const* map);
+	~ReachabilityCache();
+
+	TileHeatMap const& GetField(Unit const* unit);	// From where the unit stands now, built on first use
+	void OnUnitDied(Unit const* unit);	// Frees the unit's fields
+	void Clear();
+
+public:
+	int m_numFieldsBuilt = 0;
+	int m_numFieldsReused = 0;
+
+private:
+	Map const* m_map = nullptr;
+	std::vector<ReachabilityField*> m_fields;
+	unsigned int m_useCounter = 0;
+};
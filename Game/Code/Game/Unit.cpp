@@ -1,88 +1,7 @@
 #include "Game/Unit.hpp"
 #include "Game/Game.hpp"
 #include "Game/GameCommon.hpp"
-
-std::vector<UnitDefinitions*> UnitDefinitions::s_unitDefs;
-
-UnitDefinitions::UnitDefinitions(XmlElement& element)
-	:m_name(ParseXmlAttribute(element, "name", "")),
-	m_symbol(ParseXmlAttribute(element, "symbol", ' ')),
-	m_imageFilename(ParseXmlAttribute(element, "imageFilename", "")),
-	m_modelFilename(ParseXmlAttribute(element, "modelFilename", "")),
-	m_type(ParseXmlAttribute(element, "type", "")),
-	m_groundAttackDamage(ParseXmlAttribute(element, "groundAttackDamage", 0)),
-	m_groundAttackRangeMin(ParseXmlAttribute(element, "groundAttackRangeMin", 0)),
-	m_groundAttackRangeMax(ParseXmlAttribute(element, "groundAttackRangeMax", 0)),
-	m_movementRange(ParseXmlAttribute(element, "movementRange", 0)),
-	m_defense(ParseXmlAttribute(element, "defense", 0)),
-	m_health(ParseXmlAttribute(element, "health", 0)),
-	m_muzzlePosition(ParseXmlAttribute(element, "muzzlePosition", Vec3::ZERO)),
-	m_hitEffectName(ParseXmlAttribute(element, "hitEffectName", "")),
-	m_explosionEffectName(ParseXmlAttribute(element, "explosionEffectName", "")),
-	m_shotEffectName(ParseXmlAttribute(element, "shotEffectName", "")),
-	m_hitAudioFilename(ParseXmlAttribute(element, "hitAudioFilename", "")),
-	m_explosionAudioFilename(ParseXmlAttribute(element, "explosionAudioFilename", "")),
-	m_shotAudioFilename(ParseXmlAttribute(element, "shotAudioFilename", ""))
-{
-
-}
-
-void UnitDefinitions::InitializeUnitDefs(char const* filePath)
-{
-	XmlDocument file;
-	XmlError result = file.LoadFile(filePath);
-	GUARANTEE_OR_DIE(result == tinyxml2::XML_SUCCESS, "FILE IS NOT LOADED");
-
-	XmlElement* rootElement = file.RootElement();
-	GUARANTEE_OR_DIE(rootElement, "Root Element is null");
-
-	XmlElement* unitDefElement = rootElement->FirstChildElement();
-
-	while (unitDefElement)
-	{
-		std::string name = unitDefElement->Name();
-		GUARANTEE_OR_DIE(name == "UnitDefinition", "Root child element is in the wrong format");
-		UnitDefinitions* newUnitDef = new UnitDefinitions(*unitDefElement);
-		s_unitDefs.push_back(newUnitDef);
-		unitDefElement = unitDefElement->NextSiblingElement();
-	}
-}
-
-void UnitDefinitions::ClearDefinition()
-{
-	for (size_t i = 0; i < s_unitDefs.size(); i++)
-	{
-		if (s_unitDefs[i] != nullptr)
-		{
-			delete s_unitDefs[i];
-			s_unitDefs[i] = nullptr;
-		}
-	}
-}
-
-UnitDefinitions* UnitDefinitions::GetByName(std::string const& name)
-{
-	for (size_t i = 0; i < s_unitDefs.size(); i++)
-	{
-		if (s_unitDefs[i]->m_name == name)
-		{
-			return s_unitDefs[i];
-		}
-	}
-	return nullptr;
-}
-
-UnitDefinitions* UnitDefinitions::GetBySymbol(char symbol)
-{
-	for (size_t i = 0; i < s_unitDefs.size(); i++)
-	{
-		if (s_unitDefs[i]->m_symbol == symbol)
-		{
-			return s_unitDefs[i];
-		}
-	}
-	return nullptr;
-}
+#include "Game/ReachabilityCache.hpp"
 
 Unit::Unit(UnitDefinitions* def, int playerID, IntVec2 startcoord)
 	:m_unitDef(def), m_playerID(playerID), m_currentCoord(startcoord)
@@ -193,19 +112,19 @@ bool Unit::MoveUnit(IntVec2 newCoord)
 		return false;
 	}
 
-	IntVec2 currentCoord = m_currentCoord;
-	Tile* currentTile = m_map->GetTile(m_map->GetTileIndex(currentCoord.x, currentCoord.y));
-	Tile* newTile = m_map->GetTile(m_map->GetTileIndex(newCoord.x, newCoord.y));
+	int currentTileIndex = m_map->GetTileIndex(m_currentCoord.x, m_currentCoord.y);
+	int newTileIndex = m_map->GetTileIndex(newCoord.x, newCoord.y);
 
-	if (newTile->m_currentUnit && newTile->m_currentUnit != this)
+	Unit* newTileUnit = m_map->GetTileUnit(newTileIndex);
+	if (newTileUnit && newTileUnit != this)
 	{
 		return false;
 	}
 
-	currentTile->m_currentUnit = nullptr;
+	m_map->SetTileUnit(currentTileIndex, nullptr);
 	m_previousCoord = m_currentCoord;
 	m_currentCoord = newCoord;
-	newTile->m_currentUnit = this;
+	m_map->SetTileUnit(newTileIndex, this);
 	m_isMoved = true;
 
 	return true;
@@ -215,15 +134,16 @@ bool Unit::IsUnitOfThatCoordInAttackRange(IntVec2 coord) const
 {
 	if (m_isDead) return false;
 
-	if (!m_map->GetTile(coord)->m_currentUnit)
+	Unit* targetUnit = m_map->GetTileUnit(coord);
+	if (!targetUnit)
 	{
 		return false;
 	}
-	if (m_map->GetTile(coord)->m_currentUnit->m_playerID == m_playerID)
+	if (targetUnit->m_playerID == m_playerID)
 	{
 		return false;
 	}
-	if (!m_map->IsTileInInRangeCurrentHeatMap(coord.x, coord.y, m_unitDef->m_groundAttackRangeMax, m_unitDef->m_groundAttackRangeMin))
+	if (!m_map->IsTileInAttackRange(m_unitDef, m_currentCoord, coord))
 	{
 		return false;
 	}
@@ -245,19 +165,7 @@ bool Unit::CanAttack() const
 {
 	if (m_isDead) return false;
 
-	if (m_unitDef->m_type == "Tank")
-	{
-		return true;
-	}
-	if (m_unitDef->m_type == "Artillery")
-	{
-		if (m_previousCoord == m_currentCoord)
-		{
-			return true;
-		}
-	}
-
-	return false;
+	return m_unitDef->CanAttack(m_previousCoord != m_currentCoord);
 }
 
 void Unit::TakeDamage(int damage)
@@ -268,17 +176,18 @@ void Unit::TakeDamage(int damage)
 	m_damangeBillboardPosition = m_model->m_position;
 	m_damangeBillboardColor = Rgba8::COLOR_RED;
 	m_damangeBillboardScale = 1.f;
-	m_damageTaken = (int)(2 * damage / m_unitDef->m_defense);
+	m_damageTaken = m_unitDef->GetDamageTaken(damage);
 
 	m_health -= m_damageTaken;
 
 	if (m_health <= 0)
 	{
-		int angularDir = g_theRNG->RollRandomSign();
+		int angularDir = m_map->m_rng.RollRandomSign();
 		PlayEffect(m_unitDef->m_hitEffectName, m_model->m_position, EulerAngles(), Rgba8(206, 74, 37),Vec3::ZERO, FloatRange(-0.05f, 0.05f), EulerAngles(5 * (float)angularDir, 0, 0), FloatRange(0.7f, 0.8f), Vec2(0.4f, 0.4f), 0.8f, IntRange(2, 3));
 		PlayEffect(m_unitDef->m_explosionEffectName, m_model->m_position, EulerAngles(), Rgba8::COLOR_DARK_GRAY, Vec3::ZERO, FloatRange(-0.2f, 0.2f), EulerAngles(30 * (float)angularDir, 0, 0), FloatRange(1.4f, 1.7f), Vec2(0.7f, 0.7f), 1.2f, IntRange(4, 7));
 		m_isDead = true;
-		m_map->GetTile(m_currentCoord)->m_currentUnit = nullptr;
+		m_map->SetTileUnit(m_map->GetTileIndex(m_currentCoord.x, m_currentCoord.y), nullptr);
+		m_map->m_reachabilityCache->OnUnitDied(this);
 		m_explodeSound.playback = g_theAudio->StartSound(m_explodeSound.id);
 	}
 	else
@@ -295,11 +204,12 @@ void Unit::TakeDamage(int damage)
 	}
 }
 
-void Unit::Attack(Tile* tile)
+void Unit::Attack(IntVec2 coord)
 {
 	if (m_isDead) return;
 
-	if (!tile->m_currentUnit)
+	Unit* targetUnit = m_map->GetTileUnit(coord);
+	if (!targetUnit)
 	{
 		return;
 	}
@@ -309,8 +219,8 @@ void Unit::Attack(Tile* tile)
 		+ m_unitDef->m_muzzlePosition.z * m_model->GetModeMatrix().GetKBasis3D();
 
 	PlayEffect(m_unitDef->m_shotEffectName, m_model->m_position + particlePos, m_model->m_orientation, Rgba8::COLOR_ORANGE, Vec3::ZERO, FloatRange(-0.f, 0.f), EulerAngles(0, 0, 0), FloatRange(0.5f, 0.7f), Vec2(0.1f, 0.1f), 0.5f, IntRange(1, 1));
-	tile->m_currentUnit->m_unitAttackedMe = this;
-	tile->m_currentUnit->TakeDamage(m_unitDef->m_groundAttackDamage);
+	targetUnit->m_unitAttackedMe = this;
+	targetUnit->TakeDamage(m_unitDef->m_groundAttackDamage);
 
 	m_attackSound.playback = g_theAudio->StartSound(m_attackSound.id);
 }
@@ -319,12 +229,9 @@ void Unit::Cancel()
 {
 	if (m_isMoved)
 	{
-		Tile* currentTile = m_map->GetTile(m_map->GetTileIndex(m_currentCoord.x, m_currentCoord.y));
-		Tile* previousTile = m_map->GetTile(m_map->GetTileIndex(m_previousCoord.x, m_previousCoord.y));
-
-		currentTile->m_currentUnit = nullptr;
+		m_map->SetTileUnit(m_map->GetTileIndex(m_currentCoord.x, m_currentCoord.y), nullptr);
 		m_currentCoord = m_previousCoord;
-		previousTile->m_currentUnit = this;
+		m_map->SetTileUnit(m_map->GetTileIndex(m_currentCoord.x, m_currentCoord.y), this);
 		m_isMoved = false;
 		m_playingMoveAnim = false;
 	}
@@ -334,20 +241,20 @@ void Unit::Cancel()
 	g_theAudio->StopSound(m_moveSound.playback);
 }
 
-void Unit::SetData(Unit* unit)
+void Unit::SetData(UnitPlacement const& placement)
 {
 	m_isSelected = false;
 	m_isMoved = false;
 	m_isDoneForThisTurn = false;
 	m_isDead = false;
 
-	m_unitDef = unit->m_unitDef;
-	m_currentCoord = unit->m_currentCoord;
+	m_unitDef = placement.m_unitDef;
+	m_currentCoord = placement.m_coord;
 	m_previousCoord = m_currentCoord;
-	m_playerID = unit->m_playerID;
-	m_health = unit->m_unitDef->m_health;
+	m_playerID = placement.m_playerID;
+	m_health = placement.m_unitDef->m_health;
 
-	m_map->GetTile(m_currentCoord)->m_currentUnit = this;
+	m_map->SetTileUnit(m_map->GetTileIndex(m_currentCoord.x, m_currentCoord.y), this);
 }
 
 void Unit::Play_MoveAnimation(IntVec2 targetCoord)
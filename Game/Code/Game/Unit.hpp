@@ -6,42 +6,6 @@
 constexpr float ANIM_PLAYRATE = 3.0f;
 constexpr float ANIM_DAMAGE_TIME = 2.f;
 
-struct UnitDefinitions
-{
-	char m_symbol = ' ';
-	std::string m_name = " ";
-	std::string m_imageFilename = " ";
-	std::string m_modelFilename = " ";
-	std::string m_type = " ";
-
-	Vec3 m_muzzlePosition;
-
-	std::string m_hitEffectName = " ";
-	std::string m_explosionEffectName = " ";
-	std::string m_shotEffectName = " ";
-
-	std::string m_hitAudioFilename = " ";
-	std::string m_explosionAudioFilename = " ";
-	std::string m_shotAudioFilename = " ";
-
-	int m_groundAttackDamage = 0;
-	int m_groundAttackRangeMin = 0;
-	int m_groundAttackRangeMax = 0;
-	int m_movementRange = 0;
-	int m_defense = 0;
-	int m_health = 0;
-
-
-public:
-	UnitDefinitions(XmlElement& element);
-
-	static void InitializeUnitDefs(char const* filePath);
-	static void ClearDefinition();
-	static UnitDefinitions* GetByName(std::string const& name);
-	static UnitDefinitions* GetBySymbol(char symbol);
-	static std::vector<UnitDefinitions*> s_unitDefs;
-};
-
 class Unit
 {
 public:
@@ -60,10 +24,10 @@ public:
 	bool CanAttack() const;
 
 	void TakeDamage(int damage);
-	void Attack(Tile* tile);
+	void Attack(IntVec2 coord);
 	void Cancel();
 
-	void SetData(Unit* unit);
+	void SetData(UnitPlacement const& placement);
 
 	void Play_MoveAnimation(IntVec2 targetCoord);
 	void RotateToHex(IntVec2 coord, float maxDeltaDegree);
@@ -0,0 +1,378 @@
+//-----------------------------------------------------------------------------------------------
+// Main_JobSystemBenchmark.cpp
+//
+// Headless JobSystem benchmark, no window, renderer or DevConsole. Run it before and after a scheduler
+// change (stealing, parking, pooling) and compare the tables.
+//
+// Windows: JobSystemBenchmark project in Vaporum.sln
+// Linux, from the repository root:
+//	g++ -std=c++20 -O2 -pthread -IEngine/Code -o JobSystemBenchmark Game/Code/JobSystemBenchmark/Main_JobSystemBenchmark.cpp
+//		Engine/Code/Engine/Core/JobSystem.cpp Engine/Code/Engine/Core/JobTask.cpp Engine/Code/Engine/Core/Time.cpp Engine/Code/Engine/Core/ErrorWarningAssert.cpp Engine/Code/Engine/Core/StringUtils.cpp
+//
+// JobSystemBenchmark [workers=<max workers>] [jobs=<jobs per run>] [iterations=<fan-out rounds>]
+// Every configuration gets a fresh JobSystem; worker counts run 1, 2, 4... up to the maximum.
+// Add -g -fsanitize=thread to the line above for a race check, the await run is the one that needs it most
+//
+
+//-----------------------------------------------------------------------------------------------
+#include "Engine/Core/JobSystem.hpp"
+#include "Engine/Core/JobTask.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Core/Time.hpp"
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Every run queues all of its jobs up front, so they have to fit in the job pool at once
+constexpr int MAX_BENCHMARK_JOBS = JOB_POOL_BLOCK_SIZE * MAX_JOB_POOL_BLOCKS - 1024;
+
+struct BenchmarkSettings
+{
+	int m_maxWorkers = 1;
+	int m_numJobs = 50000;
+	int m_numIterations = 2000;
+	int m_fanOut = 64;
+};
+
+struct BenchmarkResult
+{
+	double m_jobsPerSecond = 0.0;
+	double m_p50Microseconds = 0.0;
+	double m_p99Microseconds = 0.0;
+};
+
+// Spins just long enough for a job to look like a small piece of game work instead of nothing at all
+static void BusyWorkMicroseconds(double microseconds)
+{
+	double endSeconds = GetCurrentTimeSeconds() + microseconds * 0.000001;
+	while (GetCurrentTimeSeconds() < endSeconds)
+	{
+	}
+}
+
+// Only the workers run jobs, the main thread just watches the counter
+static void WaitForCount(std::atomic<int> const& count, int target)
+{
+	while (count.load(std::memory_order_acquire) < target)
+	{
+		std::this_thread::yield();
+	}
+}
+
+static void GetPercentiles(std::vector<double>& samples, BenchmarkResult& out_result)
+{
+	if (samples.empty())
+	{
+		return;
+	}
+
+	std::sort(samples.begin(), samples.end());
+	out_result.m_p50Microseconds = samples[(samples.size() - 1) / 2] * 1000000.0;
+	out_result.m_p99Microseconds = samples[((samples.size() - 1) * 99) / 100] * 1000000.0;
+}
+
+static JobSystem* CreateBenchmarkJobSystem(int numWorkers)
+{
+	JobSystemConfig config;
+	config.m_numWorkers = numWorkers;
+	config.m_numPreallocatedJobs = 4096;
+	config.m_collectStats = false;
+
+	JobSystem* jobSystem = new JobSystem(config);
+	jobSystem->Startup();
+	return jobSystem;
+}
+
+static void DestroyBenchmarkJobSystem(JobSystem*& jobSystem)
+{
+	jobSystem->Shutdown();
+	delete jobSystem;
+	jobSystem = nullptr;
+}
+
+//-----------------------------------------------------------------------------------------------
+// Empty pooled jobs queued from one thread: the per-job cost of queueing, claiming and completing.
+// Latency is queue to start, which grows with the backlog, so it is mostly a fairness number here
+static BenchmarkResult RunEmptyJobThroughput(int numWorkers, BenchmarkSettings const& settings)
+{
+	JobSystem* jobSystem = CreateBenchmarkJobSystem(numWorkers);
+
+	std::vector<double> latencies(settings.m_numJobs);
+	std::atomic<int> numCompleted = 0;
+	double* latencyData = latencies.data();
+
+	double startSeconds = GetCurrentTimeSeconds();
+	for (int jobIndex = 0; jobIndex < settings.m_numJobs; jobIndex++)
+	{
+		double queuedSeconds = GetCurrentTimeSeconds();
+		jobSystem->QueueFunction([latencyData, jobIndex, queuedSeconds, &numCompleted]()
+		{
+			latencyData[jobIndex] = GetCurrentTimeSeconds() - queuedSeconds;
+			numCompleted.fetch_add(1, std::memory_order_release);
+		}, 1, JobCompletionPolicy::AUTO_RELEASE);
+	}
+	WaitForCount(numCompleted, settings.m_numJobs);
+	double elapsedSeconds = GetCurrentTimeSeconds() - startSeconds;
+
+	DestroyBenchmarkJobSystem(jobSystem);
+
+	BenchmarkResult result;
+	result.m_jobsPerSecond = (double)settings.m_numJobs / elapsedSeconds;
+	GetPercentiles(latencies, result);
+	return result;
+}
+
+//-----------------------------------------------------------------------------------------------
+// m_fanOut children feeding one join job through AddDependency, timed from queueing the first child to
+// the join finishing. This is the shape of a frame's update fan-out and the number that matters for frame time
+static BenchmarkResult RunFanOutFanIn(int numWorkers, BenchmarkSettings const& settings)
+{
+	JobSystem* jobSystem = CreateBenchmarkJobSystem(numWorkers);
+
+	std::vector<double> latencies;
+	latencies.reserve(settings.m_numIterations);
+	std::vector<JobHandle> children(settings.m_fanOut);
+	std::atomic<int> numJoined = 0;
+
+	double startSeconds = GetCurrentTimeSeconds();
+	for (int iteration = 0; iteration < settings.m_numIterations; iteration++)
+	{
+		// An AUTO_RELEASE prerequisite has to be wired up before it is queued
+		JobHandle joinJob = jobSystem->CreateJob([&numJoined]() { numJoined.fetch_add(1, std::memory_order_release); }, 1, JobCompletionPolicy::AUTO_RELEASE);
+		for (int childIndex = 0; childIndex < settings.m_fanOut; childIndex++)
+		{
+			children[childIndex] = jobSystem->CreateJob([]() { BusyWorkMicroseconds(2.0); }, 1, JobCompletionPolicy::AUTO_RELEASE);
+			jobSystem->AddDependency(jobSystem->GetJob(joinJob), jobSystem->GetJob(children[childIndex]));
+		}
+		jobSystem->QueueJob(joinJob);
+
+		double iterationStartSeconds = GetCurrentTimeSeconds();
+		for (int childIndex = 0; childIndex < settings.m_fanOut; childIndex++)
+		{
+			jobSystem->QueueJob(children[childIndex]);
+		}
+		WaitForCount(numJoined, iteration + 1);
+		latencies.push_back(GetCurrentTimeSeconds() - iterationStartSeconds);
+	}
+	double elapsedSeconds = GetCurrentTimeSeconds() - startSeconds;
+
+	DestroyBenchmarkJobSystem(jobSystem);
+
+	BenchmarkResult result;
+	result.m_jobsPerSecond = (double)(settings.m_numIterations * (settings.m_fanOut + 1)) / elapsedSeconds;
+	GetPercentiles(latencies, result);
+	return result;
+}
+
+//-----------------------------------------------------------------------------------------------
+// Half of the workers only take bitflag 2 jobs, the rest keep the default 1. Jobs come as 1, 2 and 3 (either)
+// in equal parts, so routing and the shared queue fallback are on the hot path. Latency is queue to start
+static BenchmarkResult RunMixedBitflags(int numWorkers, BenchmarkSettings const& settings)
+{
+	JobSystem* jobSystem = CreateBenchmarkJobSystem(numWorkers);
+	if (numWorkers > 1)
+	{
+		jobSystem->SetWorkerThreadJobFlags(2, numWorkers / 2);
+	}
+	else
+	{
+		// A single worker has to take both kinds or the bitflag 2 jobs never run
+		jobSystem->SetWorkerThreadJobFlags(3, 1);
+	}
+
+	int numJobs = settings.m_numJobs / 4;
+	std::vector<double> latencies(numJobs);
+	std::atomic<int> numCompleted = 0;
+	double* latencyData = latencies.data();
+
+	double startSeconds = GetCurrentTimeSeconds();
+	for (int jobIndex = 0; jobIndex < numJobs; jobIndex++)
+	{
+		unsigned int bitflags = (unsigned int)(jobIndex % 3) + 1;
+		double queuedSeconds = GetCurrentTimeSeconds();
+		jobSystem->QueueFunction([latencyData, jobIndex, queuedSeconds, &numCompleted]()
+		{
+			latencyData[jobIndex] = GetCurrentTimeSeconds() - queuedSeconds;
+			BusyWorkMicroseconds(1.0);
+			numCompleted.fetch_add(1, std::memory_order_release);
+		}, bitflags, JobCompletionPolicy::AUTO_RELEASE);
+	}
+	WaitForCount(numCompleted, numJobs);
+	double elapsedSeconds = GetCurrentTimeSeconds() - startSeconds;
+
+	DestroyBenchmarkJobSystem(jobSystem);
+
+	BenchmarkResult result;
+	result.m_jobsPerSecond = (double)numJobs / elapsedSeconds;
+	GetPercentiles(latencies, result);
+	return result;
+}
+
+//-----------------------------------------------------------------------------------------------
+// Every worker produces: one seed job per worker queues its share of empty jobs from inside the job system,
+// so the owner deques, stealing and the completion path all see traffic from every thread at once.
+// Latency is the per-job queue to start
+static BenchmarkResult RunContention(int numWorkers, BenchmarkSettings const& settings)
+{
+	JobSystem* jobSystem = CreateBenchmarkJobSystem(numWorkers);
+
+	int numJobsPerSeed = settings.m_numJobs / numWorkers;
+	int numJobs = numJobsPerSeed * numWorkers;
+	std::vector<double> latencies(numJobs);
+	std::atomic<int> numCompleted = 0;
+	double* latencyData = latencies.data();
+
+	double startSeconds = GetCurrentTimeSeconds();
+	for (int seedIndex = 0; seedIndex < numWorkers; seedIndex++)
+	{
+		jobSystem->QueueFunction([jobSystem, latencyData, seedIndex, numJobsPerSeed, &numCompleted]()
+		{
+			for (int jobIndex = seedIndex * numJobsPerSeed; jobIndex < (seedIndex + 1) * numJobsPerSeed; jobIndex++)
+			{
+				double queuedSeconds = GetCurrentTimeSeconds();
+				jobSystem->QueueFunction([latencyData, jobIndex, queuedSeconds, &numCompleted]()
+				{
+					latencyData[jobIndex] = GetCurrentTimeSeconds() - queuedSeconds;
+					numCompleted.fetch_add(1, std::memory_order_release);
+				}, 1, JobCompletionPolicy::AUTO_RELEASE);
+			}
+		}, 1, JobCompletionPolicy::AUTO_RELEASE);
+	}
+	WaitForCount(numCompleted, numJobs);
+	double elapsedSeconds = GetCurrentTimeSeconds() - startSeconds;
+
+	DestroyBenchmarkJobSystem(jobSystem);
+
+	BenchmarkResult result;
+	result.m_jobsPerSecond = (double)numJobs / elapsedSeconds;
+	GetPercentiles(latencies, result);
+	return result;
+}
+
+//-----------------------------------------------------------------------------------------------
+// One task per worker, each queueing an AUTO_RELEASE job and co_await-ing its handle in a loop. Most jobs finish
+// and get recycled before the await starts, which is exactly the race AwaitJob has to survive; run it under
+// -fsanitize=thread after touching the pool or the continuations. Latency is queue to resume
+static JobTask AwaitQueuedJobs(JobSystem* jobSystem, int numAwaits, double* latencyData, std::atomic<int>& numAwaited)
+{
+	std::atomic<int> numJobsRun = 0;
+	for (int awaitIndex = 0; awaitIndex < numAwaits; awaitIndex++)
+	{
+		double queuedSeconds = GetCurrentTimeSeconds();
+		JobHandle job = jobSystem->QueueFunction([awaitIndex, &numJobsRun]()
+		{
+			if ((awaitIndex & 7) == 0)
+			{
+				BusyWorkMicroseconds(2.0);
+			}
+			numJobsRun.fetch_add(1, std::memory_order_release);
+		}, 1, JobCompletionPolicy::AUTO_RELEASE);
+		co_await AwaitJob(job);
+
+		GUARANTEE_OR_DIE(numJobsRun.load(std::memory_order_acquire) == awaitIndex + 1, "AwaitJob resumed before the awaited job ran");
+		latencyData[awaitIndex] = GetCurrentTimeSeconds() - queuedSeconds;
+	}
+	numAwaited.fetch_add(numAwaits, std::memory_order_release);
+}
+
+static BenchmarkResult RunAwaitJob(int numWorkers, BenchmarkSettings const& settings)
+{
+	JobSystem* jobSystem = CreateBenchmarkJobSystem(numWorkers);
+
+	int numAwaitsPerTask = settings.m_numJobs / 4 / numWorkers;
+	int numAwaits = numAwaitsPerTask * numWorkers;
+	std::vector<double> latencies(numAwaits);
+	std::atomic<int> numAwaited = 0;
+	std::vector<JobTask> tasks(numWorkers);
+
+	double startSeconds = GetCurrentTimeSeconds();
+	for (int taskIndex = 0; taskIndex < numWorkers; taskIndex++)
+	{
+		tasks[taskIndex] = AwaitQueuedJobs(jobSystem, numAwaitsPerTask, latencies.data() + taskIndex * numAwaitsPerTask, numAwaited);
+		tasks[taskIndex].Start(jobSystem);
+	}
+	WaitForCount(numAwaited, numAwaits);
+	double elapsedSeconds = GetCurrentTimeSeconds() - startSeconds;
+
+	// The counter goes up just before each task's final suspend, let the frames finish before they are destroyed
+	for (JobTask& task : tasks)
+	{
+		task.Wait();
+	}
+	tasks.clear();
+	DestroyBenchmarkJobSystem(jobSystem);
+
+	BenchmarkResult result;
+	result.m_jobsPerSecond = (double)numAwaits / elapsedSeconds;
+	GetPercentiles(latencies, result);
+	return result;
+}
+
+//-----------------------------------------------------------------------------------------------
+static int GetArgumentValue(int argc, char** argv, char const* keyName, int defaultValue)
+{
+	size_t keyLength = strlen(keyName);
+	for (int argIndex = 1; argIndex < argc; argIndex++)
+	{
+		if (strncmp(argv[argIndex], keyName, keyLength) == 0 && argv[argIndex][keyLength] == '=')
+		{
+			return atoi(argv[argIndex] + keyLength + 1);
+		}
+	}
+	return defaultValue;
+}
+
+typedef BenchmarkResult (*BenchmarkFunction)(int numWorkers, BenchmarkSettings const& settings);
+
+struct Benchmark
+{
+	char const* m_name;
+	BenchmarkFunction m_function;
+};
+
+int main(int argc, char** argv)
+{
+	int numHardwareThreads = (int)std::thread::hardware_concurrency();
+
+	BenchmarkSettings settings;
+	settings.m_maxWorkers = GetArgumentValue(argc, argv, "workers", (numHardwareThreads > 1) ? numHardwareThreads - 1 : 1);
+	settings.m_numJobs = GetArgumentValue(argc, argv, "jobs", settings.m_numJobs);
+	settings.m_numIterations = GetArgumentValue(argc, argv, "iterations", settings.m_numIterations);
+	if (settings.m_maxWorkers < 1 || settings.m_numJobs < 1 || settings.m_numJobs > MAX_BENCHMARK_JOBS || settings.m_numIterations < 1)
+	{
+		printf("Usage: JobSystemBenchmark [workers=<max workers>] [jobs=<jobs per run, up to %i>] [iterations=<fan-out rounds>]\n", MAX_BENCHMARK_JOBS);
+		return 1;
+	}
+
+	// Powers of two up to the maximum, plus the maximum itself
+	std::vector<int> workerCounts;
+	for (int numWorkers = 1; numWorkers < settings.m_maxWorkers; numWorkers *= 2)
+	{
+		workerCounts.push_back(numWorkers);
+	}
+	workerCounts.push_back(settings.m_maxWorkers);
+
+	Benchmark const benchmarks[] =
+	{
+		{ "empty",		RunEmptyJobThroughput },
+		{ "fan-out",	RunFanOutFanIn },
+		{ "bitflags",	RunMixedBitflags },
+		{ "contention",	RunContention },
+		{ "await",		RunAwaitJob },
+	};
+
+	printf("JobSystem benchmark: %i hardware threads, %i jobs per run, %i fan-out rounds of %i\n", numHardwareThreads, settings.m_numJobs, settings.m_numIterations, settings.m_fanOut);
+	printf("%-12s %8s %14s %12s %12s\n", "benchmark", "workers", "jobs/sec", "p50 (us)", "p99 (us)");
+	for (Benchmark const& benchmark : benchmarks)
+	{
+		for (int numWorkers : workerCounts)
+		{
+			BenchmarkResult result = benchmark.m_function(numWorkers, settings);
+			printf("%-12s %8i %14.0f %12.2f %12.2f\n", benchmark.m_name, numWorkers, result.m_jobsPerSecond, result.m_p50Microseconds, result.m_p99Microseconds);
+			fflush(stdout);
+		}
+	}
+
+	return 0;
+}
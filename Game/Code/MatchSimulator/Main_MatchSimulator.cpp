@@ -0,0 +1,129 @@
+//-----------------------------------------------------------------------------------------------
+// Main_MatchSimulator.cpp
+//
+// Headless match simulator, no window, renderer, audio or FMOD. Plays batches of MatchAI against MatchAI by the
+// game's rules across every core; run it before and after a balance change and compare the tables.
+//
+// Windows: MatchSimulator project in Vaporum.sln
+// Linux, from the repository root:
+//	g++ -std=c++20 -O2 -pthread -IEngine/Code -IGame/Code -o Game/Run/MatchSimulator Game/Code/MatchSimulator/Main_MatchSimulator.cpp
+//		Game/Code/Game/GameDefinitions.cpp Game/Code/Game/HexRangeTable.cpp Game/Code/Game/MatchSimulation.cpp Game/Code/Game/MatchAI.cpp
+//		Game/Code/Game/MatchBatch.cpp Engine/Code/Engine/Core/EngineCommon.cpp Engine/Code/Engine/Core/ErrorWarningAssert.cpp
+//		Engine/Code/Engine/Core/StringUtils.cpp Engine/Code/Engine/Core/XmlUtils.cpp Engine/Code/Engine/Core/Rgba8.cpp
+//		Engine/Code/Engine/Core/JobSystem.cpp Engine/Code/Engine/Core/Time.cpp Engine/Code/Engine/Math/*.cpp
+//		Engine/Code/ThirdParty/TinyXML2/tinyxml2.cpp Engine/Code/ThirdParty/SquirrelNoise/*.cpp
+//
+// MatchSimulator [map=Grid12x12] [matches=1000] [seed=0] [workers=<hardware threads - 1>]
+// Match i always plays from the same seed, so the results and digest only change with seed, never with workers.
+// Run from Game/Run so the definition files resolve
+//
+
+//-----------------------------------------------------------------------------------------------
+#include "Game/GameDefinitions.hpp"
+#include "Game/MatchBatch.hpp"
+#include "Engine/Core/JobSystem.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//-----------------------------------------------------------------------------------------------
+static char const* GetArgumentString(int argc, char** argv, char const* keyName, char const* defaultValue)
+{
+	size_t keyLength = strlen(keyName);
+	for (int argIndex = 1; argIndex < argc; argIndex++)
+	{
+		if (strncmp(argv[argIndex], keyName, keyLength) == 0 && argv[argIndex][keyLength] == '=')
+		{
+			return argv[argIndex] + keyLength + 1;
+		}
+	}
+	return defaultValue;
+}
+
+static int GetArgumentValue(int argc, char** argv, char const* keyName, int defaultValue)
+{
+	char const* value = GetArgumentString(argc, argv, keyName, nullptr);
+	return value ? atoi(value) : defaultValue;
+}
+
+static double GetPercent(int count, int total)
+{
+	return (total > 0) ? 100.0 * (double)count / (double)total : 0.0;
+}
+
+static double GetAverage(int sum, int count)
+{
+	return (count > 0) ? (double)sum / (double)count : 0.0;
+}
+
+int main(int argc, char** argv)
+{
+	int numHardwareThreads = (int)std::thread::hardware_concurrency();
+
+	MatchBatchSettings settings;
+	std::string mapName = GetArgumentString(argc, argv, "map", "Grid12x12");
+	settings.m_numMatches = GetArgumentValue(argc, argv, "matches", 1000);
+	settings.m_seed = (unsigned int)GetArgumentValue(argc, argv, "seed", 0);
+	int numWorkers = GetArgumentValue(argc, argv, "workers", (numHardwareThreads > 1) ? numHardwareThreads - 1 : 0);
+	if (settings.m_numMatches < 1 || numWorkers < 0)
+	{
+		printf("Usage: MatchSimulator [map=<map name>] [matches=<number of matches>] [seed=<batch seed>] [workers=<worker threads, 0 for none>]\n");
+		return 1;
+	}
+
+	TileDefinition::InitializeTileDefs("Data/Definitions/TileDefinitions.xml");
+	UnitDefinitions::InitializeUnitDefs("Data/Definitions/UnitDefinitions.xml");
+	MapDefinition::InitializeMapDefs("Data/Definitions/MapDefinitions.xml");
+
+	settings.m_mapDef = MapDefinition::GetByName(mapName);
+	GUARANTEE_OR_DIE(settings.m_mapDef, Stringf("No map named \"%s\"", mapName.c_str()));
+
+	JobSystem* jobSystem = nullptr;
+	if (numWorkers > 0)
+	{
+		JobSystemConfig config;
+		config.m_numWorkers = numWorkers;
+		config.m_collectStats = false;
+		jobSystem = new JobSystem(config);
+		jobSystem->Startup();
+	}
+
+	MatchBatchResults results;
+	double startSeconds = GetCurrentTimeSeconds();
+	RunMatchBatch(settings, results, jobSystem);
+	double elapsedSeconds = GetCurrentTimeSeconds() - startSeconds;
+
+	if (jobSystem)
+	{
+		jobSystem->Shutdown();
+		delete jobSystem;
+		jobSystem = nullptr;
+	}
+
+	int numMatches = settings.m_numMatches;
+	printf("%s: %i matches, seed %u, %i workers, %.0f matches/sec\n", mapName.c_str(), numMatches, settings.m_seed, numWorkers, (double)numMatches / elapsedSeconds);
+	printf("player 1 won %.1f%%, player 2 won %.1f%%, %.1f%% drawn, %.1f turns per match, event digest %08x\n",
+		GetPercent(results.m_numWins[1], numMatches), GetPercent(results.m_numWins[2], numMatches), GetPercent(results.m_numWins[0], numMatches),
+		GetAverage(results.m_totalTurns, numMatches), results.m_eventDigest);
+
+	printf("\n%-16s %10s %10s %10s %10s %12s %12s\n", "unit", "fielded", "survived", "shots", "kills", "dealt/unit", "taken/unit");
+	for (size_t typeIndex = 0; typeIndex < results.m_unitTypeStats.size(); typeIndex++)
+	{
+		UnitTypeStats const& stats = results.m_unitTypeStats[typeIndex];
+		if (stats.m_numFielded == 0)
+		{
+			continue;
+		}
+		printf("%-16s %10i %9.1f%% %10i %10i %12.2f %12.2f\n", UnitDefinitions::s_unitDefs[typeIndex]->m_name.c_str(), stats.m_numFielded,
+			GetPercent(stats.m_numSurvived, stats.m_numFielded), stats.m_numShots, stats.m_numKills,
+			GetAverage(stats.m_damageDealt, stats.m_numFielded), GetAverage(stats.m_damageTaken, stats.m_numFielded));
+	}
+
+	MapDefinition::ClearDefinition();
+	UnitDefinitions::ClearDefinition();
+	TileDefinition::ClearDefinition();
+	return 0;
+}
@@ -0,0 +1,256 @@
+//-----------------------------------------------------------------------------------------------
+// Main_NetLoopbackTest.cpp
+//
+// Two-process check of the socket layer and framing NetWorkSystem runs on, no window or DevConsole. Start the
+// server, then the client in another shell; the client sends length-prefixed frames out of a NetRingBuffer, the
+// server echoes every byte back, and the client decodes the frames in place and checks each one.
+//
+// Windows: NetLoopbackTest project in Vaporum.sln
+// Linux, from the repository root:
+//	g++ -std=c++20 -O2 -IEngine/Code -o NetLoopbackTest Game/Code/NetLoopbackTest/Main_NetLoopbackTest.cpp
+//		Engine/Code/Engine/Network/NetSocket.cpp Engine/Code/Engine/Network/NetRingBuffer.cpp Engine/Code/Engine/Core/Time.cpp Engine/Code/Engine/Core/ErrorWarningAssert.cpp
+//		Engine/Code/Engine/Core/StringUtils.cpp
+//
+// NetLoopbackTest server [address=:3100]
+// NetLoopbackTest client [address=127.0.0.1:3100] [messages=10000]
+// The client exits 0 once every echo matched; the server exits after its client disconnects
+//
+
+//-----------------------------------------------------------------------------------------------
+#include "Engine/Network/NetSocket.hpp"
+#include "Engine/Network/NetRingBuffer.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include <chrono>
+#include <thread>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+constexpr int LOOPBACK_BUFFER_SIZE = 2048;
+constexpr double CONNECT_TIMEOUT_SECONDS = 10.0;
+
+static void WaitForSocket()
+{
+	std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+//-----------------------------------------------------------------------------------------------
+static int RunServer(NetAddress const& address)
+{
+	NetSocket listenSocket;
+	if (!listenSocket.OpenTcp() || !listenSocket.Listen(address))
+	{
+		printf("Failed to listen on %s, error %d\n", address.ToString().c_str(), GetLastNetError());
+		return 1;
+	}
+	printf("Listening on %s\n", address.ToString().c_str());
+
+	NetSocket clientSocket;
+	NetResult result = NetResult::WOULD_BLOCK;
+	while ((result = listenSocket.Accept(clientSocket)) == NetResult::WOULD_BLOCK)
+	{
+		WaitForSocket();
+	}
+	if (result != NetResult::DONE)
+	{
+		printf("Accept failed, error %d\n", GetLastNetError());
+		return 1;
+	}
+	printf("Client connected\n");
+
+	// Echo until the client hangs up, holding on to whatever the socket won't take yet
+	char buffer[LOOPBACK_BUFFER_SIZE];
+	std::string pending;
+	long long numBytesEchoed = 0;
+	for (;;)
+	{
+		int numBytesReceived = 0;
+		result = clientSocket.Receive(buffer, LOOPBACK_BUFFER_SIZE, numBytesReceived);
+		if (result == NetResult::CLOSED)
+		{
+			break;
+		}
+		if (result == NetResult::FAILED)
+		{
+			printf("Receive failed, error %d\n", GetLastNetError());
+			return 1;
+		}
+		pending.append(buffer, numBytesReceived);
+
+		int numBytesSent = 0;
+		if (!pending.empty())
+		{
+			result = clientSocket.Send(pending.data(), (int)pending.size(), numBytesSent);
+			if (result == NetResult::CLOSED)
+			{
+				break;
+			}
+			if (result == NetResult::FAILED)
+			{
+				printf("Send failed, error %d\n", GetLastNetError());
+				return 1;
+			}
+			pending.erase(0, numBytesSent);
+			numBytesEchoed += numBytesSent;
+		}
+
+		if (numBytesReceived == 0 && numBytesSent == 0)
+		{
+			WaitForSocket();
+		}
+	}
+
+	printf("Client disconnected after %lld bytes\n", numBytesEchoed);
+	return 0;
+}
+
+//-----------------------------------------------------------------------------------------------
+static int RunClient(NetAddress const& address, int numMessages)
+{
+	NetSocket socket;
+	double connectStartSeconds = GetCurrentTimeSeconds();
+	for (;;)
+	{
+		if (!socket.IsOpen() && !socket.OpenTcp())
+		{
+			printf("Failed to open a socket, error %d\n", GetLastNetError());
+			return 1;
+		}
+		NetResult result = socket.Connect(address);
+		if (result == NetResult::DONE)
+		{
+			break;
+		}
+		if (result != NetResult::WOULD_BLOCK)
+		{
+			// Most likely the server isn't up yet, start over on a fresh socket like NetWorkSystem does
+			socket.Close();
+		}
+		if (GetCurrentTimeSeconds() - connectStartSeconds > CONNECT_TIMEOUT_SECONDS)
+		{
+			printf("Could not connect to %s\n", address.ToString().c_str());
+			return 1;
+		}
+		WaitForSocket();
+	}
+	printf("Connected to %s\n", address.ToString().c_str());
+
+	// Every message goes out as one burst, the way BurstTest queues them, topping up the send ring as it drains
+	NetRingBuffer sendRing;
+	NetRingBuffer recvRing;
+	sendRing.Initialize(LOOPBACK_BUFFER_SIZE);
+	recvRing.Initialize(LOOPBACK_BUFFER_SIZE);
+	char scratch[MAX_NET_FRAME_PAYLOAD];
+
+	double startSeconds = GetCurrentTimeSeconds();
+	int numMessagesQueued = 0;
+	int numMessagesChecked = 0;
+	long long numBytesEchoed = 0;
+	while (numMessagesChecked < numMessages)
+	{
+		std::string message;
+		while (numMessagesQueued < numMessages)
+		{
+			message = Stringf("echo message=%i", numMessagesQueued);
+			if (!sendRing.WriteFrame(message.data(), (int)message.size()))
+			{
+				break;
+			}
+			numMessagesQueued++;
+		}
+
+		int numBytesMoved = 0;
+		int numBytesToSend = 0;
+		char const* sendSpan = sendRing.GetReadSpan(numBytesToSend);
+		NetResult result = NetResult::WOULD_BLOCK;
+		if (numBytesToSend > 0)
+		{
+			result = socket.Send(sendSpan, numBytesToSend, numBytesMoved);
+			sendRing.Consume(numBytesMoved);
+		}
+		if (result != NetResult::CLOSED && result != NetResult::FAILED)
+		{
+			int numFreeBytes = 0;
+			char* recvSpan = recvRing.GetWriteSpan(numFreeBytes);
+			int numBytesReceived = 0;
+			result = socket.Receive(recvSpan, numFreeBytes, numBytesReceived);
+			recvRing.CommitWrite(numBytesReceived);
+			numBytesMoved += numBytesReceived;
+			numBytesEchoed += numBytesReceived;
+		}
+		if (result == NetResult::CLOSED || result == NetResult::FAILED)
+		{
+			printf("Lost the server after %i of %i messages, error %d\n", numMessagesChecked, numMessages, GetLastNetError());
+			return 1;
+		}
+
+		char const* payload = nullptr;
+		int numPayloadBytes = 0;
+		NetFrameResult frameResult;
+		while ((frameResult = recvRing.PeekFrame(payload, numPayloadBytes, scratch)) == NetFrameResult::READY)
+		{
+			message = Stringf("echo message=%i", numMessagesChecked);
+			if (numPayloadBytes != (int)message.size() || memcmp(payload, message.data(), numPayloadBytes) != 0)
+			{
+				printf("Echo mismatch at message %i\n", numMessagesChecked);
+				return 1;
+			}
+			recvRing.ConsumeFrame(numPayloadBytes);
+			numMessagesChecked++;
+		}
+		if (frameResult == NetFrameResult::INVALID)
+		{
+			printf("Bad frame header after message %i\n", numMessagesChecked);
+			return 1;
+		}
+
+		if (numBytesMoved == 0)
+		{
+			WaitForSocket();
+		}
+	}
+	double elapsedSeconds = GetCurrentTimeSeconds() - startSeconds;
+	socket.Close();
+
+	printf("%i messages, %lld bytes echoed in %.3f ms\n", numMessages, numBytesEchoed, elapsedSeconds * 1000.0);
+	return 0;
+}
+
+//-----------------------------------------------------------------------------------------------
+static char const* GetArgumentString(int argc, char** argv, char const* keyName, char const* defaultValue)
+{
+	size_t keyLength = strlen(keyName);
+	for (int argIndex = 2; argIndex < argc; argIndex++)
+	{
+		if (strncmp(argv[argIndex], keyName, keyLength) == 0 && argv[argIndex][keyLength] == '=')
+		{
+			return argv[argIndex] + keyLength + 1;
+		}
+	}
+	return defaultValue;
+}
+
+int main(int argc, char** argv)
+{
+	bool isServer = argc > 1 && strcmp(argv[1], "server") == 0;
+	bool isClient = argc > 1 && strcmp(argv[1], "client") == 0;
+	NetAddress address;
+	std::string addressString = GetArgumentString(argc, argv, "address", isServer ? ":3100" : "127.0.0.1:3100");
+	int numMessages = atoi(GetArgumentString(argc, argv, "messages", "10000"));
+	if ((!isServer && !isClient) || !NetAddress::FromString(addressString, address) || numMessages < 1)
+	{
+		printf("Usage: NetLoopbackTest server [address=:<port>]\n");
+		printf("       NetLoopbackTest client [address=<ip>:<port>] [messages=<number of messages>]\n");
+		return 1;
+	}
+
+	if (!NetStartup())
+	{
+		printf("Failed to initialize sockets, error %d\n", GetLastNetError());
+		return 1;
+	}
+	int exitCode = isServer ? RunServer(address) : RunClient(address, numMessages);
+	NetShutdown();
+	return exitCode;
+}
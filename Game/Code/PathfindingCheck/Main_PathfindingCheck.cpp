@@ -0,0 +1,320 @@
+//-----------------------------------------------------------------------------------------------
+// Main_PathfindingCheck.cpp
+//
+// Headless check of the game's movement searches against a plain reference, no window, renderer or audio.
+// Every round scrambles the size, terrain, tile costs, movement ranges and unit positions of a loaded map, then
+// compares each unit's move costs with a textbook binary heap Dijkstra, and its HexBitGrid step layers with a
+// breadth first search. Units are scattered over the map on purpose: they never block movement, so neither
+// answer may change with where anybody stands.
+// Run it after touching the distance fields, the move cost tables, the buckets or the bit grid shifts.
+//
+// Windows: PathfindingCheck project in Vaporum.sln
+// Linux, from the repository root:
+//	g++ -std=c++20 -O2 -IEngine/Code -IGame/Code -o Game/Run/PathfindingCheck Game/Code/PathfindingCheck/Main_PathfindingCheck.cpp
+//		Game/Code/Game/GameDefinitions.cpp Game/Code/Game/HexRangeTable.cpp Game/Code/Game/HexBitGrid.cpp Game/Code/Game/MatchSimulation.cpp
+//		Engine/Code/Engine/Core/EngineCommon.cpp Engine/Code/Engine/Core/ErrorWarningAssert.cpp Engine/Code/Engine/Core/StringUtils.cpp
+//		Engine/Code/Engine/Core/XmlUtils.cpp Engine/Code/Engine/Core/Rgba8.cpp Engine/Code/Engine/Core/NamedStrings.cpp Engine/Code/Engine/Core/Time.cpp
+//		Engine/Code/Engine/Math/*.cpp Engine/Code/ThirdParty/TinyXML2/tinyxml2.cpp Engine/Code/ThirdParty/SquirrelNoise/*.cpp
+//
+// PathfindingCheck [rounds=200] [seed=0]
+// Exits 0 when every field matched, otherwise prints the first mismatch and exits 1. Run from Game/Run so the
+// definition files resolve
+//
+
+//-----------------------------------------------------------------------------------------------
+#include "Game/GameDefinitions.hpp"
+#include "Game/MatchSimulation.hpp"
+#include "Game/HexBitGrid.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Math/RandomNumberGenerator.hpp"
+#include <functional>
+#include <queue>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+constexpr int MAX_CHECK_MOVE_COST = 4;
+constexpr int MAX_CHECK_MOVEMENT_RANGE = 16;
+constexpr int MAX_CHECK_GRID_WIDTH = 150;	// Past two bit grid words, so rows carry between words
+constexpr int MAX_CHECK_GRID_HEIGHT = 40;
+
+// Owns the scrambled copies one round plays on, so the loaded definitions are never touched
+struct CheckRound
+{
+	explicit CheckRound(MapDefinition const& baseMapDef) : m_mapDef(baseMapDef) {}
+
+	MapDefinition m_mapDef;
+	std::vector<UnitDefinitions> m_unitDefs;
+};
+
+//-----------------------------------------------------------------------------------------------
+static int GetArgumentValue(int argc, char** argv, char const* keyName, int defaultValue)
+{
+	size_t keyLength = strlen(keyName);
+	for (int argIndex = 1; argIndex < argc; argIndex++)
+	{
+		if (strncmp(argv[argIndex], keyName, keyLength) == 0 && argv[argIndex][keyLength] == '=')
+		{
+			return atoi(argv[argIndex] + keyLength + 1);
+		}
+	}
+	return defaultValue;
+}
+
+//-----------------------------------------------------------------------------------------------
+// Every other round keeps the map's size, the rest get a random one. Then random terrain with a few holes cut out
+// of the world bounds, random per-unit tile costs and ranges, and units dropped on random walkable tiles
+static void ScrambleRound(CheckRound& round, RandomNumberGenerator& rng)
+{
+	MapDefinition& mapDef = round.m_mapDef;
+	if (rng.RollRandomChance(0.5f))
+	{
+		mapDef.m_gridSize = IntVec2(rng.RollRandomIntInRange(1, MAX_CHECK_GRID_WIDTH), rng.RollRandomIntInRange(1, MAX_CHECK_GRID_HEIGHT));
+		mapDef.m_tiles.m_flags.resize((size_t)mapDef.m_gridSize.x * mapDef.m_gridSize.y);
+		mapDef.m_tiles.m_occupants.assign(mapDef.m_tiles.m_flags.size(), NO_TILE_OCCUPANT);
+	}
+
+	int numTileTypes = (int)TileDefinition::s_tileDefs.size();
+	float blockedChance = rng.RollRandomFloatInRange(0.f, 0.4f);
+
+	std::vector<int> walkableTiles;
+	for (int tileIndex = 0; tileIndex < (int)mapDef.m_tiles.m_flags.size(); tileIndex++)
+	{
+		int type = rng.RollRandomIntLessThan(numTileTypes);
+		unsigned char flags = (unsigned char)type;
+		if (TileDefinition::s_tileDefs[type]->m_isBlocked || rng.RollRandomChance(blockedChance))
+		{
+			flags |= TILE_FLAG_BLOCKED;
+		}
+		if (rng.RollRandomChance(0.03f))
+		{
+			flags |= TILE_FLAG_OUT_OF_BOUNDS;
+		}
+		mapDef.m_tiles.m_flags[tileIndex] = flags;
+		if ((flags & TILE_FLAGS_NOT_WALKABLE) == 0)
+		{
+			walkableTiles.push_back(tileIndex);
+		}
+	}
+
+	round.m_unitDefs.clear();
+	for (size_t i = 0; i < UnitDefinitions::s_unitDefs.size(); i++)
+	{
+		UnitDefinitions unitDef = *UnitDefinitions::s_unitDefs[i];
+		unitDef.m_movementRange = rng.RollRandomIntInRange(1, MAX_CHECK_MOVEMENT_RANGE);
+		for (size_t type = 0; type < unitDef.m_tileMoveCosts.size(); type++)
+		{
+			unitDef.m_tileMoveCosts[type] = rng.RollRandomIntInRange(1, MAX_CHECK_MOVE_COST);
+		}
+		round.m_unitDefs.push_back(unitDef);
+	}
+
+	mapDef.m_units.clear();
+	int numUnits = rng.RollRandomIntInRange(1, 24);
+	IntVec2 gridSize = mapDef.m_gridSize;
+	for (int unitIndex = 0; unitIndex < numUnits && !walkableTiles.empty(); unitIndex++)
+	{
+		int pick = rng.RollRandomIntLessThan((int)walkableTiles.size());
+		int tileIndex = walkableTiles[pick];
+		walkableTiles[pick] = walkableTiles.back();
+		walkableTiles.pop_back();
+
+		UnitPlacement placement;
+		placement.m_unitDef = &round.m_unitDefs[rng.RollRandomIntLessThan((int)round.m_unitDefs.size())];
+		placement.m_playerID = 1 + (unitIndex & 1);
+		placement.m_coord = IntVec2(tileIndex % gridSize.x, tileIndex / gridSize.x);
+		mapDef.m_units.push_back(placement);
+	}
+}
+
+// Textbook Dijkstra with a binary heap, walkable tiles only, nothing past the unit's movement range
+static void PopulateReferenceMoveCosts(MapDefinition const& mapDef, UnitDefinitions const& unitDef, IntVec2 start, std::vector<int>& out_costs)
+{
+	typedef std::pair<int, int> CostAndIndex;
+	IntVec2 gridSize = mapDef.m_gridSize;
+	std::vector<unsigned char> const& tileFlags = mapDef.m_tiles.m_flags;
+	out_costs.assign(tileFlags.size(), -1);
+
+	std::priority_queue<CostAndIndex, std::vector<CostAndIndex>, std::greater<CostAndIndex>> openList;
+	int startIndex = start.y * gridSize.x + start.x;
+	out_costs[startIndex] = 0;
+	openList.push(CostAndIndex(0, startIndex));
+
+	while (!openList.empty())
+	{
+		CostAndIndex current = openList.top();
+		openList.pop();
+		if (current.first > out_costs[current.second])
+		{
+			continue;
+		}
+
+		IntVec2 coord(current.second % gridSize.x, current.second / gridSize.x);
+		for (int neighbor = 0; neighbor < NUM_HEX_NEIGHBORS; neighbor++)
+		{
+			IntVec2 neighborCoord = coord + HEX_NEIGHBOR_OFFSETS[neighbor];
+			if (neighborCoord.x < 0 || neighborCoord.y < 0 || neighborCoord.x >= gridSize.x || neighborCoord.y >= gridSize.y)
+			{
+				continue;
+			}
+			int neighborIndex = neighborCoord.y * gridSize.x + neighborCoord.x;
+			if ((tileFlags[neighborIndex] & TILE_FLAGS_NOT_WALKABLE) != 0)
+			{
+				continue;
+			}
+
+			int cost = current.first + unitDef.m_tileMoveCosts[tileFlags[neighborIndex] & TILE_TYPE_MASK];
+			if (cost > unitDef.m_movementRange || (out_costs[neighborIndex] != -1 && out_costs[neighborIndex] <= cost))
+			{
+				continue;
+			}
+			out_costs[neighborIndex] = cost;
+			openList.push(CostAndIndex(cost, neighborIndex));
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+static bool CheckMoveCosts(CheckRound const& round, int roundIndex, int& out_numFieldsChecked)
+{
+	MatchSimulation match(&round.m_mapDef);
+	std::vector<int> costs;
+	std::vector<int> referenceCosts;
+
+	for (int unitIndex = 0; unitIndex < (int)match.m_units.size(); unitIndex++)
+	{
+		MatchUnit const& unit = match.m_units[unitIndex];
+		match.PopulateMoveCosts(unitIndex, costs);
+		PopulateReferenceMoveCosts(round.m_mapDef, *unit.m_unitDef, unit.m_coord, referenceCosts);
+		out_numFieldsChecked++;
+
+		for (int tileIndex = 0; tileIndex < (int)costs.size(); tileIndex++)
+		{
+			if (costs[tileIndex] != referenceCosts[tileIndex])
+			{
+				IntVec2 coord = match.GetTileCoord(tileIndex);
+				printf("Move costs differ in round %i, map %s at %ix%i, unit %i from (%i, %i): tile (%i, %i) has %i, reference %i\n",
+					roundIndex, round.m_mapDef.m_name.c_str(), round.m_mapDef.m_gridSize.x, round.m_mapDef.m_gridSize.y, unitIndex, unit.m_coord.x, unit.m_coord.y, coord.x, coord.y, costs[tileIndex], referenceCosts[tileIndex]);
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+// Breadth first, one step per walkable tile, the same as the reference with every tile costing 1
+static void PopulateReferenceSteps(MapDefinition const& mapDef, IntVec2 start, std::vector<int>& out_steps)
+{
+	IntVec2 gridSize = mapDef.m_gridSize;
+	std::vector<unsigned char> const& tileFlags = mapDef.m_tiles.m_flags;
+	out_steps.assign(tileFlags.size(), -1);
+
+	std::vector<int> frontier;
+	int startIndex = start.y * gridSize.x + start.x;
+	out_steps[startIndex] = 0;
+	frontier.push_back(startIndex);
+	for (size_t frontierIndex = 0; frontierIndex < frontier.size(); frontierIndex++)
+	{
+		int tileIndex = frontier[frontierIndex];
+		IntVec2 coord(tileIndex % gridSize.x, tileIndex / gridSize.x);
+		for (int neighbor = 0; neighbor < NUM_HEX_NEIGHBORS; neighbor++)
+		{
+			IntVec2 neighborCoord = coord + HEX_NEIGHBOR_OFFSETS[neighbor];
+			if (neighborCoord.x < 0 || neighborCoord.y < 0 || neighborCoord.x >= gridSize.x || neighborCoord.y >= gridSize.y)
+			{
+				continue;
+			}
+			int neighborIndex = neighborCoord.y * gridSize.x + neighborCoord.x;
+			if (out_steps[neighborIndex] != -1 || (tileFlags[neighborIndex] & TILE_FLAGS_NOT_WALKABLE) != 0)
+			{
+				continue;
+			}
+			out_steps[neighborIndex] = out_steps[tileIndex] + 1;
+			frontier.push_back(neighborIndex);
+		}
+	}
+}
+
+// The layers are kept across rounds and maps of different sizes, the way Map reuses its own
+static bool CheckStepLayers(CheckRound const& round, int roundIndex, std::vector<HexBitGrid>& layers, int& out_numLayersChecked)
+{
+	MapDefinition const& mapDef = round.m_mapDef;
+	IntVec2 gridSize = mapDef.m_gridSize;
+	HexBitGrid walkable(gridSize);
+	for (int tileIndex = 0; tileIndex < (int)mapDef.m_tiles.m_flags.size(); tileIndex++)
+	{
+		if ((mapDef.m_tiles.m_flags[tileIndex] & TILE_FLAGS_NOT_WALKABLE) == 0)
+		{
+			walkable.Set(IntVec2(tileIndex % gridSize.x, tileIndex / gridSize.x));
+		}
+	}
+
+	std::vector<int> referenceSteps;
+	for (int unitIndex = 0; unitIndex < (int)mapDef.m_units.size(); unitIndex++)
+	{
+		UnitPlacement const& unit = mapDef.m_units[unitIndex];
+		int maxSteps = unit.m_unitDef->m_movementRange;
+		HexBitGrid::PopulateStepLayers(layers, unit.m_coord, maxSteps, walkable);
+		PopulateReferenceSteps(mapDef, unit.m_coord, referenceSteps);
+
+		for (int step = 0; step <= maxSteps; step++)
+		{
+			out_numLayersChecked++;
+			for (int tileIndex = 0; tileIndex < (int)referenceSteps.size(); tileIndex++)
+			{
+				IntVec2 coord(tileIndex % gridSize.x, tileIndex / gridSize.x);
+				bool isReferenceSet = referenceSteps[tileIndex] != -1 && referenceSteps[tileIndex] <= step;
+				if (layers[step].IsSet(coord) != isReferenceSet)
+				{
+					printf("Step layers differ in round %i, map %s at %ix%i, unit %i from (%i, %i): layer %i %s tile (%i, %i), reference is %i steps\n",
+						roundIndex, mapDef.m_name.c_str(), gridSize.x, gridSize.y, unitIndex, unit.m_coord.x, unit.m_coord.y, step, isReferenceSet ? "misses" : "has",
+						coord.x, coord.y, referenceSteps[tileIndex]);
+					return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	int numRounds = GetArgumentValue(argc, argv, "rounds", 200);
+	unsigned int seed = (unsigned int)GetArgumentValue(argc, argv, "seed", 0);
+	if (numRounds < 1)
+	{
+		printf("Usage: PathfindingCheck [rounds=<rounds per map>] [seed=<seed>]\n");
+		return 1;
+	}
+
+	TileDefinition::InitializeTileDefs("Data/Definitions/TileDefinitions.xml");
+	UnitDefinitions::InitializeUnitDefs("Data/Definitions/UnitDefinitions.xml");
+	MapDefinition::InitializeMapDefs("Data/Definitions/MapDefinitions.xml");
+	GUARANTEE_OR_DIE(!MapDefinition::s_mapDefs.empty(), "No maps to scramble");
+
+	RandomNumberGenerator rng(seed);
+	std::vector<HexBitGrid> layers;
+	int numFieldsChecked = 0;
+	int numLayersChecked = 0;
+	bool isMatching = true;
+	for (size_t mapIndex = 0; mapIndex < MapDefinition::s_mapDefs.size() && isMatching; mapIndex++)
+	{
+		for (int roundIndex = 0; roundIndex < numRounds && isMatching; roundIndex++)
+		{
+			CheckRound round(*MapDefinition::s_mapDefs[mapIndex]);
+			ScrambleRound(round, rng);
+			isMatching = CheckMoveCosts(round, roundIndex, numFieldsChecked) && CheckStepLayers(round, roundIndex, layers, numLayersChecked);
+		}
+	}
+
+	if (isMatching)
+	{
+		printf("Move costs: %i fields over %i scrambled maps match the reference Dijkstra\n", numFieldsChecked, numRounds * (int)MapDefinition::s_mapDefs.size());
+		printf("Step layers: %i layers match the reference breadth first search\n", numLayersChecked);
+	}
+
+	MapDefinition::ClearDefinition();
+	UnitDefinitions::ClearDefinition();
+	TileDefinition::ClearDefinition();
+	return isMatching ? 0 : 1;
+}